@@ -0,0 +1,132 @@
+#ifndef UNORDEREDMAPTASK__AGGREGATINGMAP_H_
+#define UNORDEREDMAPTASK__AGGREGATINGMAP_H_
+
+#include <vector>
+#include <functional>
+#include "UnorderedMap.h"
+#include "ThreadPool.h"
+#include "HashMix.h"
+
+///
+///AggregatingMap: per-thread partial maps radix-partitioned by hash bits,
+///merge() combines matching partitions in parallel by relinking nodes
+///
+
+template<typename Key, typename Acc, typename Combine = std::plus<Acc>, typename Hash = std::hash<Key>,
+         typename Equal = std::equal_to<Key>, typename Alloc = std::allocator<std::pair<const Key, Acc>>>
+class AggregatingMap {
+public:
+    typedef UnorderedMap<Key, Acc, Hash, Equal, Alloc> Map;
+
+    explicit AggregatingMap(size_t numThreads, size_t radixBits = 6);
+
+    void add(size_t thread, const Key& key, const Acc& value);
+    void merge(ThreadPool& pool = ThreadPool::global());
+
+    size_t numPartitions() const;
+    const Map& partition(size_t index) const;
+    size_t size() const;
+    const Acc& at(const Key& key) const;
+    template<typename F>
+    void for_each(F f) const;
+
+private:
+    std::vector<std::vector<Map>> partials_;
+    size_t numPartitions_;
+    Hash hash;
+    Combine combine;
+
+    size_t partitionIndex_(const Key& key) const;
+};
+
+
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::AggregatingMap(size_t numThreads, size_t radixBits)
+        : partials_(),
+          numPartitions_(size_t(1) << radixBits),
+          hash(),
+          combine() {
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+
+    partials_.resize(numThreads);
+    for (auto& partial : partials_) {
+        partial.resize(numPartitions_);
+    }
+}
+
+///-----
+///Aggregation
+///-----
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+void AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::add(size_t thread, const Key& key, const Acc& value) {
+    Map& partition = partials_[thread][partitionIndex_(key)];
+
+    auto it = partition.find(key);
+    if (it != partition.end()) {
+        it->second = combine(std::move(it->second), value);
+    } else {
+        partition.emplace(key, value);
+    }
+}
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+void AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::merge(ThreadPool& pool) {
+    // Partitions with the same index hold disjoint keys from every other index, so each one is merged
+    // into the first thread's partition independently.
+    pool.run(numPartitions_, [this](size_t index) {
+        for (size_t thread = 1; thread < partials_.size(); ++thread) {
+            partials_[0][index].merge(partials_[thread][index], combine);
+        }
+    });
+}
+
+///-----
+///Merged result
+///-----
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+size_t AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::numPartitions() const {
+    return numPartitions_;
+}
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+const typename AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::Map&
+AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::partition(size_t index) const {
+    return partials_[0][index];
+}
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+size_t AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::size() const {
+    size_t size = 0;
+    for (auto& partition : partials_[0]) {
+        size += partition.size();
+    }
+
+    return size;
+}
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+const Acc& AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::at(const Key& key) const {
+    return partials_[0][partitionIndex_(key)].at(key);
+}
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+template<typename F>
+void AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::for_each(F f) const {
+    for (auto& partition : partials_[0]) {
+        for (auto& node : partition) {
+            f(node);
+        }
+    }
+}
+
+template<typename Key, typename Acc, typename Combine, typename Hash, typename Equal, typename Alloc>
+size_t AggregatingMap<Key, Acc, Combine, Hash, Equal, Alloc>::partitionIndex_(const Key& key) const {
+    return mixHash(hash(key)) & (numPartitions_ - 1);
+}
+
+#endif //UNORDEREDMAPTASK__AGGREGATINGMAP_H_
@@ -0,0 +1,202 @@
+#ifndef UNORDEREDMAPTASK__BLOOMFILTER_H_
+#define UNORDEREDMAPTASK__BLOOMFILTER_H_
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include "HashMix.h"
+
+///
+///BloomFilter: blocked Bloom filter over precomputed hashes, every key sets kProbes bits
+///inside a single 64-byte block, so a query touches one cache line.
+///Blocks come from Alloc rebound to the block type, so the filter shares its map's allocator
+///
+
+template<typename Alloc = std::allocator<char>>
+class BloomFilter {
+public:
+    explicit BloomFilter(const Alloc& alloc = Alloc(), size_t bitsPerKey = 10);
+    BloomFilter(const BloomFilter& other, const Alloc& alloc);
+    BloomFilter(BloomFilter&& other) noexcept;
+    ~BloomFilter();
+    BloomFilter& operator=(const BloomFilter& other) = delete;
+    BloomFilter& operator=(BloomFilter&& other) = delete;
+
+    void reset(size_t capacity);
+    void clear();
+    void add(size_t hash);
+    bool mayContain(size_t hash) const;
+
+    size_t capacity() const;
+    size_t memory_usage() const;
+    size_t memoryFor(size_t capacity) const;
+
+    template<bool propagateAlloc>
+    void swap(BloomFilter& other);
+
+private:
+    static constexpr size_t kProbes_ = 6;
+    static constexpr size_t kBlockBits_ = 512;
+
+    struct alignas(64) Block_ {
+        uint64_t words[kBlockBits_ / 64];
+    };
+
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Block_> BlockAlloc_;
+    typedef std::allocator_traits<BlockAlloc_> BlockAllocTraits_;
+
+    BlockAlloc_ blockAlloc_;
+    Block_* blocks_;
+    size_t numBlocks_;
+    size_t capacity_;
+    size_t bitsPerKey_;
+
+    size_t blocksFor_(size_t capacity) const;
+    size_t blockIndex_(size_t mixed) const;
+    void free_();
+};
+
+
+
+template<typename Alloc>
+BloomFilter<Alloc>::BloomFilter(const Alloc& alloc, size_t bitsPerKey)
+        : blockAlloc_(alloc),
+          blocks_(nullptr),
+          numBlocks_(0),
+          capacity_(0),
+          bitsPerKey_(bitsPerKey) {
+}
+
+template<typename Alloc>
+BloomFilter<Alloc>::BloomFilter(const BloomFilter& other, const Alloc& alloc)
+        : blockAlloc_(alloc),
+          blocks_(nullptr),
+          numBlocks_(other.numBlocks_),
+          capacity_(other.capacity_),
+          bitsPerKey_(other.bitsPerKey_) {
+    if (numBlocks_ > 0) {
+        blocks_ = BlockAllocTraits_::allocate(blockAlloc_, numBlocks_);
+        std::copy(other.blocks_, other.blocks_ + numBlocks_, blocks_);
+    }
+}
+
+template<typename Alloc>
+BloomFilter<Alloc>::BloomFilter(BloomFilter&& other) noexcept
+        : blockAlloc_(std::move(other.blockAlloc_)),
+          blocks_(other.blocks_),
+          numBlocks_(other.numBlocks_),
+          capacity_(other.capacity_),
+          bitsPerKey_(other.bitsPerKey_) {
+    other.blocks_ = nullptr;
+    other.numBlocks_ = 0;
+    other.capacity_ = 0;
+}
+
+template<typename Alloc>
+BloomFilter<Alloc>::~BloomFilter() {
+    free_();
+}
+
+template<typename Alloc>
+void BloomFilter<Alloc>::reset(size_t capacity) {
+    size_t numBlocks = blocksFor_(capacity);
+    if (numBlocks != numBlocks_) {
+        // Allocate before freeing, so a failed allocation leaves the old blocks in place.
+        Block_* blocks = numBlocks > 0 ? BlockAllocTraits_::allocate(blockAlloc_, numBlocks) : nullptr;
+        free_();
+        blocks_ = blocks;
+        numBlocks_ = numBlocks;
+    }
+
+    capacity_ = capacity;
+    clear();
+}
+
+template<typename Alloc>
+void BloomFilter<Alloc>::clear() {
+    std::fill(blocks_, blocks_ + numBlocks_, Block_());
+}
+
+template<typename Alloc>
+void BloomFilter<Alloc>::add(size_t hash) {
+    size_t mixed = mixHash(hash);
+    Block_& block = blocks_[blockIndex_(mixed)];
+
+    // Double hashing inside the block, from the low half of the mix; the upper half picked the block.
+    size_t bit = mixed & (kBlockBits_ - 1);
+    size_t step = (mixed >> 9) | 1;
+    for (size_t i = 0; i < kProbes_; ++i, bit = (bit + step) & (kBlockBits_ - 1)) {
+        block.words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+}
+
+template<typename Alloc>
+bool BloomFilter<Alloc>::mayContain(size_t hash) const {
+    if (numBlocks_ == 0) {
+        return false;
+    }
+
+    size_t mixed = mixHash(hash);
+    const Block_& block = blocks_[blockIndex_(mixed)];
+
+    size_t bit = mixed & (kBlockBits_ - 1);
+    size_t step = (mixed >> 9) | 1;
+    for (size_t i = 0; i < kProbes_; ++i, bit = (bit + step) & (kBlockBits_ - 1)) {
+        if ((block.words[bit / 64] & (uint64_t(1) << (bit % 64))) == 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template<typename Alloc>
+size_t BloomFilter<Alloc>::capacity() const {
+    return capacity_;
+}
+
+template<typename Alloc>
+size_t BloomFilter<Alloc>::memory_usage() const {
+    return numBlocks_ * sizeof(Block_);
+}
+
+template<typename Alloc>
+size_t BloomFilter<Alloc>::memoryFor(size_t capacity) const {
+    return blocksFor_(capacity) * sizeof(Block_);
+}
+
+template<typename Alloc>
+template<bool propagateAlloc>
+void BloomFilter<Alloc>::swap(BloomFilter& other) {
+    if constexpr (propagateAlloc) {
+        std::swap(blockAlloc_, other.blockAlloc_);
+    }
+    std::swap(blocks_, other.blocks_);
+    std::swap(numBlocks_, other.numBlocks_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(bitsPerKey_, other.bitsPerKey_);
+}
+
+template<typename Alloc>
+size_t BloomFilter<Alloc>::blocksFor_(size_t capacity) const {
+    return capacity == 0 ? 0 : (capacity * bitsPerKey_ + kBlockBits_ - 1) / kBlockBits_;
+}
+
+template<typename Alloc>
+size_t BloomFilter<Alloc>::blockIndex_(size_t mixed) const {
+    // Multiply-shift maps the upper 32 bits onto [0, blocks) without a division.
+    uint64_t upper = static_cast<uint64_t>(mixed) >> 32;
+    return static_cast<size_t>((upper * numBlocks_) >> 32);
+}
+
+template<typename Alloc>
+void BloomFilter<Alloc>::free_() {
+    if (blocks_ != nullptr) {
+        BlockAllocTraits_::deallocate(blockAlloc_, blocks_, numBlocks_);
+    }
+    blocks_ = nullptr;
+    numBlocks_ = 0;
+}
+
+#endif //UNORDEREDMAPTASK__BLOOMFILTER_H_
@@ -0,0 +1,325 @@
+#ifndef UNORDEREDMAPTASK__COWUM_H_
+#define UNORDEREDMAPTASK__COWUM_H_
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <stdexcept>
+#include "UnorderedMap.h"
+#include "HashMix.h"
+
+///
+///CowUnorderedMap: UnorderedMap split into copy-on-write shards,
+///snapshot() shares the shard table in O(1); the first write after a snapshot copies the table of shard
+///pointers and every write copies only the shard it touches, whose size is bounded because the shard
+///count doubles as the map grows
+///
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>,
+         typename Equal = std::equal_to<Key>, typename Alloc = std::allocator<std::pair<const Key, Value>>>
+class CowUnorderedMap {
+public:
+    typedef UnorderedMap<Key, Value, Hash, Equal, Alloc> Map;
+    typedef typename Map::NodeType NodeType;
+
+    class Snapshot {
+    public:
+        size_t size() const;
+        size_t count(const Key& key) const;
+        const Value& at(const Key& key) const;
+        template<typename F>
+        void for_each(F f) const;
+
+    private:
+        std::shared_ptr<const std::vector<std::shared_ptr<Map>>> table_;
+        size_t size_;
+        Hash hash;
+        friend class CowUnorderedMap;
+    };
+
+    explicit CowUnorderedMap(size_t numShards = 64);
+
+    Snapshot snapshot() const;
+
+    Value& operator[](const Key& key);
+    const Value& at(const Key& key) const;
+    Value& at(const Key& key);
+    size_t count(const Key& key) const;
+
+    size_t size() const;
+
+    bool insert(const NodeType& node);
+    bool insert(NodeType&& node);
+    template<typename ...Args>
+    bool emplace(Args&& ... args);
+    size_t erase(const Key& key);
+    void clear();
+
+    template<typename F>
+    void for_each(F f) const;
+
+private:
+    static constexpr size_t kMaxShardSize_ = 4096;
+    typedef std::vector<std::shared_ptr<Map>> Table_;
+
+    std::shared_ptr<Table_> table_;
+    size_t size_;
+    Hash hash;
+
+    static size_t shardOf_(const Hash& hash, const Key& key, size_t numShards);
+    size_t shardIndex_(const Key& key) const;
+    Table_& writableTable_();
+    Map& writableShard_(size_t index);
+    template<typename T>
+    static bool owns_(const std::shared_ptr<T>& pointer);
+    void checkShardSize_();
+};
+
+
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::CowUnorderedMap(size_t numShards)
+        : table_(std::make_shared<Table_>()),
+          size_(0),
+          hash() {
+    size_t powerOfTwo = 1;
+    while (powerOfTwo < numShards) {
+        powerOfTwo *= 2;
+    }
+
+    table_->reserve(powerOfTwo);
+    for (size_t i = 0; i < powerOfTwo; ++i) {
+        table_->push_back(std::make_shared<Map>());
+    }
+}
+
+///-----
+///Snapshot
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::Snapshot::size() const {
+    return size_;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::Snapshot::count(const Key& key) const {
+    const Map& shard = *(*table_)[shardOf_(hash, key, table_->size())];
+    return shard.find(key) != shard.end() ? 1 : 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+const Value& CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::Snapshot::at(const Key& key) const {
+    return static_cast<const Map&>(*(*table_)[shardOf_(hash, key, table_->size())]).at(key);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename F>
+void CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::Snapshot::for_each(F f) const {
+    for (auto& shard : *table_) {
+        for (auto& node : static_cast<const Map&>(*shard)) {
+            f(node);
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::Snapshot
+CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::snapshot() const {
+    Snapshot snapshot;
+    snapshot.table_ = table_;
+    snapshot.size_ = size_;
+    snapshot.hash = hash;
+
+    return snapshot;
+}
+
+///-----
+///lookup
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value& CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator[](const Key& key) {
+    size_t index = shardIndex_(key);
+    const Map& shard = *(*table_)[index];
+    auto it = shard.find(key);
+    if (it != shard.end()) {
+        return writableShard_(index).at(key);
+    }
+
+    Value& value = writableShard_(index)[key];
+    ++size_;
+    if (size_ <= table_->size() * kMaxShardSize_) {
+        return value;
+    }
+
+    checkShardSize_();
+    return writableShard_(shardIndex_(key)).at(key);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+const Value& CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) const {
+    return static_cast<const Map&>(*(*table_)[shardIndex_(key)]).at(key);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value& CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) {
+    size_t index = shardIndex_(key);
+    if (count(key) == 0) {
+        throw std::out_of_range("key not found");
+    }
+
+    return writableShard_(index).at(key);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::count(const Key& key) const {
+    const Map& shard = *(*table_)[shardIndex_(key)];
+    return shard.find(key) != shard.end() ? 1 : 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::size() const {
+    return size_;
+}
+
+///-----
+///Modifiers
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+bool CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(const NodeType& node) {
+    return emplace(node);
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+bool CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(NodeType&& node) {
+    return emplace(std::move(node));
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename... Args>
+bool CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::emplace(Args&& ... args) {
+    NodeType node(std::forward<Args>(args)...);
+    size_t index = shardIndex_(node.first);
+    if (count(node.first) > 0) {
+        return false;
+    }
+
+    writableShard_(index).insert(std::move(node));
+    ++size_;
+    checkShardSize_();
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const Key& key) {
+    if (count(key) == 0) {
+        return 0;
+    }
+
+    writableShard_(shardIndex_(key)).erase(key);
+    --size_;
+    return 1;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::clear() {
+    auto table = std::make_shared<Table_>(table_->size());
+    for (auto& shard : *table) {
+        shard = std::make_shared<Map>();
+    }
+    table_ = table;
+    size_ = 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename F>
+void CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::for_each(F f) const {
+    for (auto& shard : *table_) {
+        for (auto& node : static_cast<const Map&>(*shard)) {
+            f(node);
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::shardOf_(const Hash& hash, const Key& key,
+                                                                 size_t numShards) {
+    return mixHash(hash(key)) & (numShards - 1);
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::shardIndex_(const Key& key) const {
+    return shardOf_(hash, key, table_->size());
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::Table_&
+CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::writableTable_() {
+    // A table still referenced by a snapshot is copied before the first write; the copy shares every
+    // shard, so the shards themselves stay copy-on-write.
+    if (!owns_(table_)) {
+        table_ = std::make_shared<Table_>(*table_);
+    }
+
+    return *table_;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::Map&
+CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::writableShard_(size_t index) {
+    // A shard still referenced by an older table is copied before the first write.
+    Table_& table = writableTable_();
+    if (!owns_(table[index])) {
+        table[index] = std::make_shared<Map>(*table[index]);
+    }
+
+    return *table[index];
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename T>
+bool CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::owns_(const std::shared_ptr<T>& pointer) {
+    if (pointer.use_count() != 1) {
+        return false;
+    }
+
+    // use_count() is a relaxed load; the fence pairs it with the release of the last reader that dropped
+    // its reference, so that reader's accesses happen before our writes.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CowUnorderedMap<Key, Value, Hash, Equal, Alloc>::checkShardSize_() {
+    if (size_ <= table_->size() * kMaxShardSize_) {
+        return;
+    }
+
+    // Split every shard in two by the next hash bit. Snapshots keep the old table and shards, shards only
+    // this map owns give up their values instead of copying them.
+    bool ownedTable = owns_(table_);
+    auto table = std::make_shared<Table_>(table_->size() * 2);
+    for (auto& shard : *table) {
+        shard = std::make_shared<Map>();
+    }
+
+    size_t mask = table->size() - 1;
+    for (auto& shard : *table_) {
+        bool owned = ownedTable && owns_(shard);
+        for (auto& node : *shard) {
+            Map& target = *(*table)[mixHash(hash(node.first)) & mask];
+            if (owned) {
+                target.emplace(node.first, std::move(node.second));
+            } else {
+                target.insert(static_cast<const NodeType&>(node));
+            }
+        }
+        if (ownedTable) {
+            shard.reset();
+        }
+    }
+
+    table_ = table;
+}
+
+#endif //UNORDEREDMAPTASK__COWUM_H_
@@ -0,0 +1,190 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <unordered_map>
+#include "UnorderedMap.h"
+#include "CuckooUM.h"
+
+///
+///CuckooBenchmark: lookup and insert latency of the chained, cuckoo and an open-addressing layout,
+///build with g++ -std=c++17 -O2 CuckooBenchmark.cpp -o cuckoo_benchmark
+///
+
+///LinearProbingMap: minimal open-addressing baseline, power-of-two table with linear probing,
+///keys and values stored inline, grows at load 0.5
+class LinearProbingMap {
+public:
+    LinearProbingMap() : slots_(16), size_(0) {
+    }
+
+    void emplace(long long key, long long value) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow_();
+        }
+        Slot_& slot = slots_[index_(key)];
+        if (!slot.used) {
+            slot = Slot_{key, value, true};
+            ++size_;
+        }
+    }
+
+    const long long* find(long long key) const {
+        const Slot_& slot = slots_[index_(key)];
+        return slot.used ? &slot.value : nullptr;
+    }
+
+private:
+    struct Slot_ {
+        long long key;
+        long long value;
+        bool used;
+    };
+
+    std::vector<Slot_> slots_;
+    size_t size_;
+
+    size_t index_(long long key) const {
+        size_t mask = slots_.size() - 1;
+        size_t i = mixHash(std::hash<long long>()(key)) & mask;
+        while (slots_[i].used && slots_[i].key != key) {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    void grow_() {
+        std::vector<Slot_> old(slots_.size() * 2);
+        old.swap(slots_);
+        size_ = 0;
+        for (auto& slot : old) {
+            if (slot.used) {
+                emplace(slot.key, slot.value);
+            }
+        }
+    }
+};
+
+struct Latency {
+    double totalMs;
+    double p50Ns;
+    double p99Ns;
+    double maxNs;
+};
+
+///Repeatable operations run twice: once back to back for the total, whose independent lookups may overlap
+///in the CPU, and once with a clock read around each, which serializes them into per-operation latency
+template<typename F>
+Latency measure(size_t numOps, F f, bool repeatable = true) {
+    typedef std::chrono::steady_clock Clock;
+    std::vector<double> samples(numOps);
+
+    auto start = Clock::now();
+    if (repeatable) {
+        for (size_t i = 0; i < numOps; ++i) {
+            f(i);
+        }
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    for (size_t i = 0; i < numOps; ++i) {
+        auto before = Clock::now();
+        f(i);
+        samples[i] = std::chrono::duration<double, std::nano>(Clock::now() - before).count();
+    }
+    if (!repeatable) {
+        totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    std::sort(samples.begin(), samples.end());
+    return Latency{totalMs, samples[numOps / 2], samples[numOps * 99 / 100], samples.back()};
+}
+
+void report(const std::string& name, const std::string& op, const Latency& latency) {
+    std::cout << std::left << std::setw(22) << name << std::setw(8) << op << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << latency.totalMs << " ms   p50 "
+              << std::setw(7) << latency.p50Ns << " ns   p99 " << std::setw(7) << latency.p99Ns
+              << " ns   max " << std::setw(11) << latency.maxNs << " ns\n";
+}
+
+template<typename Insert, typename Find>
+long long run(const std::string& name, const std::vector<long long>& keys, const std::vector<long long>& hits,
+         const std::vector<long long>& misses, Insert insert, Find find) {
+    long long checksum = 0;
+    report(name, "insert", measure(keys.size(), [&](size_t i) {
+        insert(keys[i]);
+    }, false));
+    report(name, "hit", measure(hits.size(), [&](size_t i) {
+        checksum += find(hits[i]);
+    }));
+    report(name, "miss", measure(misses.size(), [&](size_t i) {
+        checksum += find(misses[i]);
+    }));
+    return checksum;
+}
+
+int main(int argc, char** argv) {
+    size_t numKeys = argc > 1 ? std::stoul(argv[1]) : 1000000;
+    size_t numLookups = 3 * numKeys;
+
+    std::mt19937_64 rng(7);
+    std::vector<long long> keys(numKeys);
+    for (auto& key : keys) {
+        key = static_cast<long long>(rng() >> 1);
+    }
+    std::vector<long long> hits(numLookups);
+    std::vector<long long> misses(numLookups);
+    for (size_t i = 0; i < numLookups; ++i) {
+        hits[i] = keys[rng() % numKeys];
+        misses[i] = -static_cast<long long>(rng() >> 1) - 1;
+    }
+
+    std::cout << numKeys << " random keys, " << numLookups << " hits and misses; lookup totals run without"
+              << " clock reads, per-operation latencies include one clock read\n";
+    report("clock overhead", "-", measure(numLookups, [](size_t) {
+    }));
+
+    long long checksum = 0;
+    {
+        UnorderedMap<long long, long long> map;
+        checksum += run("chained UnorderedMap", keys, hits, misses, [&](long long key) {
+            map.emplace(key, key);
+        }, [&](long long key) {
+            auto it = map.find(key);
+            return it != map.end() ? it->second : 0;
+        });
+    }
+    {
+        CuckooUnorderedMap<long long, long long> map;
+        checksum += run("CuckooUnorderedMap", keys, hits, misses, [&](long long key) {
+            map.emplace(key, key);
+        }, [&](long long key) {
+            auto it = map.find(key);
+            return it != map.end() ? it->second : 0;
+        });
+    }
+    {
+        LinearProbingMap map;
+        checksum += run("linear probing", keys, hits, misses, [&](long long key) {
+            map.emplace(key, key);
+        }, [&](long long key) {
+            const long long* value = map.find(key);
+            return value != nullptr ? *value : 0;
+        });
+    }
+    {
+        std::unordered_map<long long, long long> map;
+        checksum += run("std::unordered_map", keys, hits, misses, [&](long long key) {
+            map.emplace(key, key);
+        }, [&](long long key) {
+            auto it = map.find(key);
+            return it != map.end() ? it->second : 0;
+        });
+    }
+
+    std::cout << "checksum " << checksum << "\n";
+    return 0;
+}
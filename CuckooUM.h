@@ -0,0 +1,755 @@
+#ifndef UNORDEREDMAPTASK__CUCKOOUM_H_
+#define UNORDEREDMAPTASK__CUCKOOUM_H_
+
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+#include "HashMix.h"
+
+///
+///CuckooUnorderedMap: same interface as UnorderedMap, every key has exactly two candidate buckets and a
+///bucket holds the tags and entries of as many slots (2 to 8) as fit in one 64-byte cache line, so a
+///lookup touches at most two cache lines as long as two entries fit in a line.
+///Inserts displace entries along a bounded BFS path and may move other entries,
+///so any insert invalidates iterators and references. More than 2 * slots keys with one full hash
+///value cannot be placed, inserting such a key throws std::length_error; so does an insert that still finds
+///no displacement path after a few doublings of the table.
+///
+
+constexpr size_t cuckooSlotsPerLine(size_t size, size_t align) {
+    size_t slots = 2;
+    while (slots < 8 && (slots + align) / align * align + (slots + 1) * size <= 64) {
+        ++slots;
+    }
+
+    return slots;
+}
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>,
+         typename Equal = std::equal_to<Key>, typename Alloc = std::allocator<std::pair<const Key, Value>>>
+class CuckooUnorderedMap {
+public:
+    typedef std::pair<const Key, Value> NodeType;
+
+private:
+    static const size_t kSlots_ = cuckooSlotsPerLine(sizeof(NodeType), alignof(NodeType));
+    static const size_t kMaxPath_ = 256;
+    static const size_t kMaxFailedRehash_ = 4;
+
+    struct alignas(64) Bucket_ {
+        unsigned char tags[kSlots_];
+        typename std::aligned_storage<sizeof(NodeType), alignof(NodeType)>::type slots[kSlots_];
+
+        NodeType* slot(size_t i) {
+            return reinterpret_cast<NodeType*>(&slots[i]);
+        };
+        const NodeType* slot(size_t i) const {
+            return reinterpret_cast<const NodeType*>(&slots[i]);
+        };
+    };
+
+public:
+    explicit CuckooUnorderedMap(size_t numBuckets = 8, const Alloc& alloc = Alloc());
+    CuckooUnorderedMap(const CuckooUnorderedMap& other);
+    CuckooUnorderedMap(const CuckooUnorderedMap& other, const Alloc& alloc);
+    CuckooUnorderedMap(CuckooUnorderedMap&& other) noexcept;
+    ~CuckooUnorderedMap();
+    CuckooUnorderedMap& operator=(const CuckooUnorderedMap& other);
+    CuckooUnorderedMap& operator=(CuckooUnorderedMap&& other);
+
+    template<bool is_const>
+    class HelpIterator {
+    private:
+        typedef typename std::conditional<is_const, const Bucket_*, Bucket_*>::type BucketPtr_;
+        BucketPtr_ bucket_;
+        BucketPtr_ last_;
+        size_t slot_;
+        HelpIterator(BucketPtr_ bucket, size_t slot, BucketPtr_ last) : bucket_(bucket), last_(last), slot_(slot) {
+        };
+        void skipEmpty_();
+        friend class CuckooUnorderedMap;
+        template<bool> friend class HelpIterator;
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef NodeType value_type;
+        typedef int difference_type;
+        typedef typename std::conditional<is_const, const NodeType*, NodeType*>::type pointer;
+        typedef typename std::conditional<is_const, const NodeType&, NodeType&>::type reference;
+
+        HelpIterator(const HelpIterator& other);
+        template<bool other_const, typename = typename std::enable_if<is_const && !other_const>::type>
+        HelpIterator(const HelpIterator<other_const>& other)
+                : bucket_(other.bucket_), last_(other.last_), slot_(other.slot_) {
+        };
+        HelpIterator& operator=(const HelpIterator& other);
+
+        reference operator*() const;
+        pointer operator->() const;
+
+        HelpIterator& operator++();
+        HelpIterator operator++(int);
+        bool operator==(const HelpIterator& other) const;
+        bool operator!=(const HelpIterator& other) const;
+    };
+
+    typedef HelpIterator<true> ConstIterator;
+    typedef HelpIterator<false> Iterator;
+
+    Iterator begin();
+    Iterator end();
+    ConstIterator begin() const;
+    ConstIterator end() const;
+    ConstIterator cbegin() const;
+    ConstIterator cend() const;
+
+    Value& operator[](const Key& key);
+    const Value& at(const Key& key) const;
+    Value& at(const Key& key);
+    Iterator find(const Key& key);
+    ConstIterator find(const Key& key) const;
+
+    size_t size() const;
+    void rehash(size_t count);
+    void reserve(size_t count);
+    size_t max_size() const;
+    float max_load_factor() const;
+    void max_load_factor(float ml);
+    float load_factor() const;
+
+    std::pair<Iterator, bool> insert(NodeType&& node);
+    std::pair<Iterator, bool> insert(const NodeType& node);
+    template<typename T>
+    std::pair<Iterator, bool> insert(T&& node);
+    template<typename It>
+    void insert(const It& begin, const It& end);
+
+    template<typename ...Args>
+    std::pair<Iterator, bool> emplace(Args&& ... args);
+
+    void erase(Iterator it);
+    void erase(Iterator begin, Iterator end);
+    size_t erase(const Key& key);
+    void clear();
+
+    size_t bucket_count() const;
+    Alloc get_allocator() const;
+    void swap(CuckooUnorderedMap& other);
+    size_t memory_usage() const;
+
+private:
+    typedef std::allocator_traits<Alloc> AllocTraits_;
+    typedef typename AllocTraits_::template rebind_alloc<Bucket_> BucketAlloc_;
+    typedef std::allocator_traits<BucketAlloc_> BucketAllocTraits_;
+
+    struct Probe_ {
+        size_t first;
+        size_t second;
+        unsigned char tag;
+    };
+    struct PathEntry_ {
+        size_t bucket;
+        size_t parent;
+        size_t slot;
+    };
+
+    size_t numBuckets_;
+    size_t size_;
+    float maxLoadFactor_;
+    Alloc alloc_;
+    BucketAlloc_ bucketAlloc_;
+    Bucket_* buckets_;
+    Hash hash;
+    Equal equal;
+
+    Probe_ probe_(const Key& key) const;
+    std::pair<Bucket_*, size_t> findSlot_(const Key& key) const;
+    Iterator placeNew_(NodeType&& node);
+    std::pair<Bucket_*, size_t> makeRoom_(const Probe_& probe);
+    bool sharesFullHash_(const Probe_& probe, const Key& key) const;
+    void moveSlot_(Bucket_& from, size_t fromSlot, Bucket_& to, size_t toSlot);
+
+    void destroyAll_();
+    template<bool propagateAlloc>
+    void swap_(CuckooUnorderedMap& other);
+};
+
+
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::CuckooUnorderedMap(size_t numBuckets, const Alloc& alloc)
+        : numBuckets_(1),
+          size_(0),
+          maxLoadFactor_(kSlots_ > 2 ? 0.9 : 0.85),
+          alloc_(alloc),
+          bucketAlloc_(alloc),
+          buckets_(nullptr),
+          hash(),
+          equal() {
+    while (numBuckets_ < numBuckets) {
+        numBuckets_ *= 2;
+    }
+
+    buckets_ = BucketAllocTraits_::allocate(bucketAlloc_, numBuckets_);
+    for (size_t i = 0; i < numBuckets_; ++i) {
+        std::fill(buckets_[i].tags, buckets_[i].tags + kSlots_, 0);
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::CuckooUnorderedMap(const CuckooUnorderedMap& other)
+        : CuckooUnorderedMap(other, AllocTraits_::select_on_container_copy_construction(other.alloc_)) {
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::CuckooUnorderedMap(const CuckooUnorderedMap& other,
+                                                                       const Alloc& alloc)
+        : CuckooUnorderedMap(other.numBuckets_, alloc) {
+    maxLoadFactor_ = other.maxLoadFactor_;
+    hash = other.hash;
+    equal = other.equal;
+
+    // Same hash functions and bucket count, so every entry keeps its slot.
+    for (size_t i = 0; i < numBuckets_; ++i) {
+        for (size_t j = 0; j < kSlots_; ++j) {
+            if (other.buckets_[i].tags[j] != 0) {
+                AllocTraits_::construct(alloc_, buckets_[i].slot(j), *other.buckets_[i].slot(j));
+                buckets_[i].tags[j] = other.buckets_[i].tags[j];
+                ++size_;
+            }
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::CuckooUnorderedMap(CuckooUnorderedMap&& other) noexcept
+        : numBuckets_(other.numBuckets_),
+          size_(other.size_),
+          maxLoadFactor_(other.maxLoadFactor_),
+          alloc_(std::move(other.alloc_)),
+          bucketAlloc_(std::move(other.bucketAlloc_)),
+          buckets_(other.buckets_),
+          hash(std::move(other.hash)),
+          equal(std::move(other.equal)) {
+    other.buckets_ = nullptr;
+    other.size_ = 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::~CuckooUnorderedMap() {
+    if (buckets_ != nullptr) {
+        destroyAll_();
+        BucketAllocTraits_::deallocate(bucketAlloc_, buckets_, numBuckets_);
+    }
+    buckets_ = nullptr;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>&
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(const CuckooUnorderedMap& other) {
+    constexpr bool propagate = AllocTraits_::propagate_on_container_copy_assignment::value;
+    CuckooUnorderedMap tmp(other, propagate ? other.alloc_ : alloc_);
+    this->swap_<propagate>(tmp);
+
+    return *this;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>&
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(CuckooUnorderedMap&& other) {
+    constexpr bool propagate = AllocTraits_::propagate_on_container_move_assignment::value;
+    if (propagate || alloc_ == other.alloc_) {
+        CuckooUnorderedMap tmp = std::move(other);
+        this->swap_<propagate>(tmp);
+    } else {
+        CuckooUnorderedMap tmp(other.numBuckets_, alloc_);
+        tmp.maxLoadFactor_ = other.maxLoadFactor_;
+        tmp.hash = other.hash;
+        tmp.equal = other.equal;
+        for (auto it = other.begin(); it != other.end(); ++it) {
+            tmp.placeNew_(std::move(*it));
+        }
+        other.clear();
+        this->swap_<false>(tmp);
+    }
+
+    return *this;
+}
+
+///-----
+///Iterator
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::HelpIterator(
+        const CuckooUnorderedMap::HelpIterator<is_const>& other)
+        : bucket_(other.bucket_), last_(other.last_), slot_(other.slot_) {
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::template HelpIterator<is_const>&
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::operator=(
+        const CuckooUnorderedMap::HelpIterator<is_const>& other) {
+    bucket_ = other.bucket_;
+    last_ = other.last_;
+    slot_ = other.slot_;
+    return *this;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::template HelpIterator<is_const>::reference
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::operator*() const {
+    return *bucket_->slot(slot_);
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::template HelpIterator<is_const>::pointer
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::operator->() const {
+    return bucket_->slot(slot_);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::template HelpIterator<is_const>&
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::operator++() {
+    if (++slot_ == kSlots_) {
+        slot_ = 0;
+        ++bucket_;
+    }
+    skipEmpty_();
+    return *this;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::template HelpIterator<is_const>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::operator++(int) {
+    auto copy = *this;
+    ++*this;
+    return copy;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+bool CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::operator==(
+        const CuckooUnorderedMap::HelpIterator<is_const>& other) const {
+    return bucket_ == other.bucket_ && slot_ == other.slot_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+bool CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::operator!=(
+        const CuckooUnorderedMap::HelpIterator<is_const>& other) const {
+    return !(*this == other);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool is_const>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::HelpIterator<is_const>::skipEmpty_() {
+    while (bucket_ != last_ && bucket_->tags[slot_] == 0) {
+        if (++slot_ == kSlots_) {
+            slot_ = 0;
+            ++bucket_;
+        }
+    }
+}
+
+///-----
+///Methods with Iterators
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::begin() {
+    Iterator it(buckets_, 0, buckets_ + numBuckets_);
+    it.skipEmpty_();
+    return it;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::end() {
+    return Iterator(buckets_ + numBuckets_, 0, buckets_ + numBuckets_);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::ConstIterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::begin() const {
+    ConstIterator it(buckets_, 0, buckets_ + numBuckets_);
+    it.skipEmpty_();
+    return it;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::ConstIterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::end() const {
+    return ConstIterator(buckets_ + numBuckets_, 0, buckets_ + numBuckets_);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::ConstIterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::cbegin() const {
+    return begin();
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::ConstIterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::cend() const {
+    return end();
+}
+
+///-----
+///lookup
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value& CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::operator[](const Key& key) {
+    auto it = find(key);
+    if (it != end()) {
+        return it->second;
+    }
+
+    return emplace(key, Value()).first->second;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+const Value& CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) const {
+    auto it = find(key);
+    if (it != end()) {
+        return it->second;
+    }
+
+    throw std::out_of_range("key not found");
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value& CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) {
+    auto it = find(key);
+    if (it != end()) {
+        return it->second;
+    }
+
+    throw std::out_of_range("key not found");
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) {
+    auto slot = findSlot_(key);
+    if (slot.first == nullptr) {
+        return end();
+    }
+
+    return Iterator(slot.first, slot.second, buckets_ + numBuckets_);
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::ConstIterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) const {
+    auto slot = findSlot_(key);
+    if (slot.first == nullptr) {
+        return end();
+    }
+
+    return ConstIterator(slot.first, slot.second, buckets_ + numBuckets_);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Probe_
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::probe_(const Key& key) const {
+    size_t keyHash = hash(key);
+    size_t mixed = mixHash(keyHash);
+
+    Probe_ probe;
+    probe.first = mixed & (numBuckets_ - 1);
+    // The alternative bucket comes from the upper half of the same mix, one multiply instead of a second full hash.
+    size_t upper = (mixed >> (sizeof(size_t) * 4)) | (mixed << (sizeof(size_t) * 4));
+    probe.second = (upper * 0x9e3779b97f4a7c15ULL) & (numBuckets_ - 1);
+    probe.tag = static_cast<unsigned char>(mixed >> (sizeof(size_t) * 8 - 8)) | 1;
+
+    return probe;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+std::pair<typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Bucket_*, size_t>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::findSlot_(const Key& key) const {
+    Probe_ probe = probe_(key);
+
+    Bucket_* bucket = buckets_ + probe.first;
+    for (size_t round = 0; round < 2; ++round) {
+        for (size_t i = 0; i < kSlots_; ++i) {
+            if (bucket->tags[i] == probe.tag && equal(bucket->slot(i)->first, key)) {
+                return std::pair<Bucket_*, size_t>(bucket, i);
+            }
+        }
+        bucket = buckets_ + probe.second;
+    }
+
+    return std::pair<Bucket_*, size_t>(nullptr, 0);
+}
+
+///-----
+///Capacity and hash
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::size() const {
+    return size_;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::rehash(size_t count) {
+    count = std::max(count, static_cast<size_t>(std::ceil(size_ / (maxLoadFactor_ * kSlots_))));
+
+    CuckooUnorderedMap newMap(count, alloc_);
+    newMap.maxLoadFactor_ = maxLoadFactor_;
+    newMap.hash = hash;
+    newMap.equal = equal;
+
+    try {
+        for (auto it = begin(); it != end(); ++it) {
+            newMap.placeNew_(std::move(*it));
+        }
+    } catch (...) {
+        // Keys are const and therefore copied, so every moved-from entry is still found here by its key.
+        for (auto& node : newMap) {
+            find(node.first)->second = std::move(node.second);
+        }
+        throw;
+    }
+
+    this->swap_<false>(newMap);
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::reserve(size_t count) {
+    rehash(std::ceil(count / (maxLoadFactor_ * kSlots_)));
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::max_size() const {
+    return maxLoadFactor_ * numBuckets_ * kSlots_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+float CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::max_load_factor() const {
+    return maxLoadFactor_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::max_load_factor(float ml) {
+    maxLoadFactor_ = ml;
+    if (maxLoadFactor_ < load_factor()) {
+        rehash(numBuckets_ * 2);
+    }
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+float CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::load_factor() const {
+    return static_cast<float>(size_) / (numBuckets_ * kSlots_);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::bucket_count() const {
+    return numBuckets_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Alloc CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::get_allocator() const {
+    return alloc_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::swap(CuckooUnorderedMap& other) {
+    swap_<AllocTraits_::propagate_on_container_swap::value>(other);
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::memory_usage() const {
+    return numBuckets_ * sizeof(Bucket_);
+}
+
+///-----
+///Modifiers
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+std::pair<typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator, bool>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(NodeType&& node) {
+    return emplace(std::move(node));
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+std::pair<typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator, bool>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(const NodeType& node) {
+    return emplace(node);
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename T>
+std::pair<typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator, bool>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(T&& node) {
+    return emplace(std::forward<T>(node));
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename It>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(const It& begin, const It& end) {
+    for (It it = begin; it != end; ++it) {
+        insert(*it);
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename... Args>
+std::pair<typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator, bool>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::emplace(Args&& ... args) {
+    NodeType node(std::forward<Args>(args)...);
+    auto it = find(node.first);
+    if (it != end()) {
+        return std::pair<Iterator, bool>(it, false);
+    }
+
+    return std::pair<Iterator, bool>(placeNew_(std::move(node)), true);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(CuckooUnorderedMap::Iterator it) {
+    AllocTraits_::destroy(alloc_, it.bucket_->slot(it.slot_));
+    it.bucket_->tags[it.slot_] = 0;
+    --size_;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(CuckooUnorderedMap::Iterator begin,
+                                                               CuckooUnorderedMap::Iterator end) {
+    // Erasing only clears a slot, so the iterator stays valid and steps past it.
+    while (begin != end) {
+        erase(begin++);
+    }
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const Key& key) {
+    auto it = find(key);
+    if (it == end()) {
+        return 0;
+    }
+
+    erase(it);
+    return 1;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::clear() {
+    destroyAll_();
+    size_ = 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::placeNew_(NodeType&& node) {
+    if (size_ + 1 > maxLoadFactor_ * numBuckets_ * kSlots_) {
+        rehash(numBuckets_ * 2);
+    }
+
+    for (size_t failed = 0; ; ++failed) {
+        Probe_ probe = probe_(node.first);
+        auto slot = makeRoom_(probe);
+        if (slot.first != nullptr) {
+            AllocTraits_::construct(alloc_, slot.first->slot(slot.second), std::move(node));
+            slot.first->tags[slot.second] = probe.tag;
+            ++size_;
+            return Iterator(slot.first, slot.second, buckets_ + numBuckets_);
+        }
+
+        // Keys sharing the full hash value share both buckets at every table size, growing cannot help them.
+        if (sharesFullHash_(probe, node.first)) {
+            throw std::length_error("too many keys with the same hash value");
+        }
+        if (failed == kMaxFailedRehash_) {
+            throw std::length_error("no cuckoo displacement path within the search bound");
+        }
+        rehash(numBuckets_ * 2);
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+bool CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::sharesFullHash_(const Probe_& probe, const Key& key) const {
+    size_t keyHash = hash(key);
+    for (size_t index : {probe.first, probe.second}) {
+        for (size_t i = 0; i < kSlots_; ++i) {
+            if (buckets_[index].tags[i] == 0 || hash(buckets_[index].slot(i)->first) != keyHash) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+std::pair<typename CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::Bucket_*, size_t>
+CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::makeRoom_(const Probe_& probe) {
+    const size_t noParent = static_cast<size_t>(-1);
+    std::vector<PathEntry_> path;
+    path.push_back(PathEntry_{probe.first, noParent, 0});
+    if (probe.second != probe.first) {
+        path.push_back(PathEntry_{probe.second, noParent, 0});
+    }
+
+    // Breadth-first search over displacements: every entry is a bucket reachable by moving the
+    // occupant of `slot` in its parent's bucket to that occupant's other bucket.
+    for (size_t i = 0; i < path.size(); ++i) {
+        Bucket_& bucket = buckets_[path[i].bucket];
+        size_t free = std::find(bucket.tags, bucket.tags + kSlots_, 0) - bucket.tags;
+
+        if (free < kSlots_) {
+            for (size_t child = i; path[child].parent != noParent; child = path[child].parent) {
+                const PathEntry_& parent = path[path[child].parent];
+                moveSlot_(buckets_[parent.bucket], path[child].slot, buckets_[path[child].bucket], free);
+                free = path[child].slot;
+                i = path[child].parent;
+            }
+            return std::pair<Bucket_*, size_t>(&buckets_[path[i].bucket], free);
+        }
+
+        for (size_t j = 0; j < kSlots_ && path.size() < kMaxPath_; ++j) {
+            Probe_ occupant = probe_(bucket.slot(j)->first);
+            size_t other = occupant.first == path[i].bucket ? occupant.second : occupant.first;
+
+            bool onPath = false;
+            for (size_t k = i; k != noParent && !onPath; k = path[k].parent) {
+                onPath = path[k].bucket == other;
+            }
+            if (!onPath) {
+                path.push_back(PathEntry_{other, i, j});
+            }
+        }
+    }
+
+    return std::pair<Bucket_*, size_t>(nullptr, 0);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::moveSlot_(Bucket_& from, size_t fromSlot,
+                                                                   Bucket_& to, size_t toSlot) {
+    AllocTraits_::construct(alloc_, to.slot(toSlot), std::move(*from.slot(fromSlot)));
+    to.tags[toSlot] = from.tags[fromSlot];
+    AllocTraits_::destroy(alloc_, from.slot(fromSlot));
+    from.tags[fromSlot] = 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::destroyAll_() {
+    for (size_t i = 0; i < numBuckets_; ++i) {
+        for (size_t j = 0; j < kSlots_; ++j) {
+            if (buckets_[i].tags[j] != 0) {
+                AllocTraits_::destroy(alloc_, buckets_[i].slot(j));
+                buckets_[i].tags[j] = 0;
+            }
+        }
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool propagateAlloc>
+void CuckooUnorderedMap<Key, Value, Hash, Equal, Alloc>::swap_(CuckooUnorderedMap& other) {
+    std::swap(numBuckets_, other.numBuckets_);
+    std::swap(size_, other.size_);
+    std::swap(maxLoadFactor_, other.maxLoadFactor_);
+    if constexpr (propagateAlloc) {
+        std::swap(alloc_, other.alloc_);
+        std::swap(bucketAlloc_, other.bucketAlloc_);
+    }
+    std::swap(buckets_, other.buckets_);
+    std::swap(hash, other.hash);
+    std::swap(equal, other.equal);
+}
+
+#endif //UNORDEREDMAPTASK__CUCKOOUM_H_
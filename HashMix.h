@@ -0,0 +1,22 @@
+#ifndef UNORDEREDMAPTASK__HASHMIX_H_
+#define UNORDEREDMAPTASK__HASHMIX_H_
+
+#include <cstdint>
+#include <cstddef>
+
+///
+///mixHash: spreads the bits of a user hash (splitmix64 finalizer), e.g. for identity std::hash<int>
+///
+
+inline size_t mixHash(size_t hash) {
+    uint64_t x = hash;
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+
+    return static_cast<size_t>(x);
+}
+
+#endif //UNORDEREDMAPTASK__HASHMIX_H_
@@ -4,28 +4,25 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <memory>
 
 template<typename T, typename Alloc = std::allocator<T>>
 class ListUM {
 public:
-    ListUM();
+    explicit ListUM(const Alloc& alloc = Alloc());
     ListUM(const ListUM& other);
+    ListUM(const ListUM& other, const Alloc& alloc);
     ListUM(ListUM&& other) noexcept;
     ~ListUM();
     ListUM& operator=(const ListUM& other);
-    ListUM& operator=(ListUM&& other) noexcept;
+    ListUM& operator=(ListUM&& other);
 
     struct Node {
         T* key;
         Node* next;
         Node* prev;
 
-        static std::allocator_traits<Alloc> allocTraits;
-        static Alloc allocT_;
-
-        template<typename ...Args>
-        explicit Node(Args&& ...args);
-        ~Node();
+        explicit Node(T* key);
     };
 
     template<bool is_const>
@@ -40,6 +37,9 @@ public:
         HelpIterator() : now(nullptr) {
         };
         HelpIterator(const HelpIterator& other);
+        template<bool other_const, typename = typename std::enable_if<is_const && !other_const>::type>
+        HelpIterator(const HelpIterator<other_const>& other) : now(other.now) {
+        };
         HelpIterator& operator=(const HelpIterator& other);
 
         reference operator*() const;
@@ -51,6 +51,7 @@ public:
         bool operator!=(const HelpIterator& other) const;
 
         friend class ListUM;
+        template<bool> friend class HelpIterator;
     private:
         explicit HelpIterator(Node* node) : now(node) {
         };
@@ -77,33 +78,48 @@ public:
     template<typename ...Args>
     Node* makeNode(Args&& ...args);
     void delNode(Node* node);
+    template<typename ...Args>
+    void reuseNode(Node* node, Args&& ...args);
 
     void erase(Iterator it);
     Node* extractNode(Iterator it);
+    void clear();
+
+    Alloc get_allocator() const;
+    template<bool propagateAlloc>
+    void swap(ListUM& other);
 
 private:
+    typedef std::allocator_traits<Alloc> AllocTraits_;
+    typedef typename AllocTraits_::template rebind_alloc<Node> NodeAlloc_;
+    typedef std::allocator_traits<NodeAlloc_> NodeAllocTraits_;
+
     Node* first_;
     Node* last_;
 
-    typename Alloc::template rebind<Node>::other alloc_;
+    Alloc allocT_;
+    NodeAlloc_ alloc_;
 
     void connect_(Node* left, Node* right);
-    void swap_(ListUM& other);
 };
 
-template<typename T, typename Alloc>
-Alloc ListUM<T, Alloc>::Node::allocT_ = Alloc();
-template<typename T, typename Alloc>
-std::allocator_traits<Alloc> ListUM<T, Alloc>::Node::allocTraits = std::allocator_traits<Alloc>();
 
 
+template<typename T, typename Alloc>
+ListUM<T, Alloc>::ListUM(const Alloc& alloc): first_(nullptr), last_(nullptr), allocT_(alloc), alloc_(alloc) {
+}
 
 template<typename T, typename Alloc>
-ListUM<T, Alloc>::ListUM(): first_(nullptr), last_(nullptr), alloc_() {
+ListUM<T, Alloc>::ListUM(const ListUM& other)
+        : ListUM(other, AllocTraits_::select_on_container_copy_construction(other.allocT_)) {
 }
 
 template<typename T, typename Alloc>
-ListUM<T, Alloc>::ListUM(const ListUM& other): first_(nullptr), last_(nullptr), alloc_(other.alloc_) {
+ListUM<T, Alloc>::ListUM(const ListUM& other, const Alloc& alloc)
+        : first_(nullptr),
+          last_(nullptr),
+          allocT_(alloc),
+          alloc_(alloc) {
     Node* prev = nullptr;
     for (Node* node = other.first_; node != nullptr; node = node->next) {
         Node* new_node = makeNode(*(node->key));
@@ -123,6 +139,7 @@ template<typename T, typename Alloc>
 ListUM<T, Alloc>::ListUM(ListUM&& other) noexcept
         : first_(other.first_),
           last_(other.last_),
+          allocT_(std::move(other.allocT_)),
           alloc_(std::move(other.alloc_)) {
     other.first_ = nullptr;
     other.last_ = nullptr;
@@ -130,27 +147,32 @@ ListUM<T, Alloc>::ListUM(ListUM&& other) noexcept
 
 template<typename T, typename Alloc>
 ListUM<T, Alloc>::~ListUM() {
-    for (Node* node = first_, * next_node; node != nullptr; node = next_node) {
-        next_node = node->next;
-        alloc_.destroy(node);
-        alloc_.deallocate(node, 1);
-    }
-    first_ = nullptr;
-    last_ = nullptr;
+    clear();
 }
 
 template<typename T, typename Alloc>
 ListUM<T, Alloc>& ListUM<T, Alloc>::operator=(const ListUM& other) {
-    ListUM tmp = other;
-    this->swap_(tmp);
+    constexpr bool propagate = AllocTraits_::propagate_on_container_copy_assignment::value;
+    ListUM tmp(other, propagate ? other.allocT_ : allocT_);
+    this->swap<propagate>(tmp);
 
     return *this;
 }
 
 template<typename T, typename Alloc>
-ListUM<T, Alloc>& ListUM<T, Alloc>::operator=(ListUM&& other) noexcept {
-    ListUM tmp = std::move(other);
-    this->swap_(tmp);
+ListUM<T, Alloc>& ListUM<T, Alloc>::operator=(ListUM&& other) {
+    constexpr bool propagate = AllocTraits_::propagate_on_container_move_assignment::value;
+    if (propagate || allocT_ == other.allocT_) {
+        ListUM tmp = std::move(other);
+        this->swap<propagate>(tmp);
+    } else {
+        ListUM tmp(allocT_);
+        for (Node* node = other.first_; node != nullptr; node = node->next) {
+            tmp.push_back(tmp.makeNode(std::move(*(node->key))));
+        }
+        other.clear();
+        this->swap<false>(tmp);
+    }
 
     return *this;
 }
@@ -215,19 +237,7 @@ bool ListUM<T, Alloc>::HelpIterator<is_const>::operator!=(const ListUM::HelpIter
 ///-----
 
 template<typename T, typename Alloc>
-template<typename... Args>
-ListUM<T, Alloc>::Node::Node(Args&& ... args): key(nullptr), next(nullptr), prev(nullptr) {
-    key = allocTraits.allocate(allocT_, 1);
-    allocTraits.construct(allocT_, key, std::forward<Args>(args)...);
-}
-
-template<typename T, typename Alloc>
-ListUM<T, Alloc>::Node::~Node() {
-    allocTraits.destroy(allocT_, key);
-    allocTraits.deallocate(allocT_, key, 1);
-    key = nullptr;
-    next = nullptr;
-    prev = nullptr;
+ListUM<T, Alloc>::Node::Node(T* key): key(key), next(nullptr), prev(nullptr) {
 }
 
 ///-----
@@ -304,9 +314,7 @@ typename ListUM<T, Alloc>::Iterator ListUM<T, Alloc>::push_back(ListUM::Node* no
 
 template<typename T, typename Alloc>
 void ListUM<T, Alloc>::erase(ListUM::Iterator it) {
-    Node* node = extractNode(it);
-    alloc_.destroy(node);
-    alloc_.deallocate(node, 1);
+    delNode(extractNode(it));
 }
 template<typename T, typename Alloc>
 typename ListUM<T, Alloc>::Node* ListUM<T, Alloc>::extractNode(ListUM::Iterator it) {
@@ -323,6 +331,16 @@ typename ListUM<T, Alloc>::Node* ListUM<T, Alloc>::extractNode(ListUM::Iterator
     return it.now;
 }
 
+template<typename T, typename Alloc>
+void ListUM<T, Alloc>::clear() {
+    for (Node* node = first_, * next_node; node != nullptr; node = next_node) {
+        next_node = node->next;
+        delNode(node);
+    }
+    first_ = nullptr;
+    last_ = nullptr;
+}
+
 template<typename T, typename Alloc>
 void ListUM<T, Alloc>::connect_(ListUM::Node* left, ListUM::Node* right) {
     if (left != nullptr) {
@@ -335,23 +353,61 @@ void ListUM<T, Alloc>::connect_(ListUM::Node* left, ListUM::Node* right) {
 template<typename T, typename Alloc>
 template<typename... Args>
 typename ListUM<T, Alloc>::Node* ListUM<T, Alloc>::makeNode(Args&& ... args) {
-    auto* node = alloc_.allocate(1);
-    alloc_.construct(node, std::forward<Args>(args)...);
+    T* key = AllocTraits_::allocate(allocT_, 1);
+    Node* node = nullptr;
+    try {
+        AllocTraits_::construct(allocT_, key, std::forward<Args>(args)...);
+        try {
+            node = NodeAllocTraits_::allocate(alloc_, 1);
+        } catch (...) {
+            AllocTraits_::destroy(allocT_, key);
+            throw;
+        }
+    } catch (...) {
+        AllocTraits_::deallocate(allocT_, key, 1);
+        throw;
+    }
+    NodeAllocTraits_::construct(alloc_, node, key);
 
     return node;
 }
 
 template<typename T, typename Alloc>
 void ListUM<T, Alloc>::delNode(ListUM::Node* node) {
-    alloc_.destroy(node);
-    alloc_.deallocate(node, 1);
+    AllocTraits_::destroy(allocT_, node->key);
+    AllocTraits_::deallocate(allocT_, node->key, 1);
+    NodeAllocTraits_::destroy(alloc_, node);
+    NodeAllocTraits_::deallocate(alloc_, node, 1);
+}
+
+template<typename T, typename Alloc>
+template<typename... Args>
+void ListUM<T, Alloc>::reuseNode(ListUM::Node* node, Args&& ... args) {
+    AllocTraits_::destroy(allocT_, node->key);
+    try {
+        AllocTraits_::construct(allocT_, node->key, std::forward<Args>(args)...);
+    } catch (...) {
+        AllocTraits_::deallocate(allocT_, node->key, 1);
+        NodeAllocTraits_::destroy(alloc_, node);
+        NodeAllocTraits_::deallocate(alloc_, node, 1);
+        throw;
+    }
 }
 
 template<typename T, typename Alloc>
-void ListUM<T, Alloc>::swap_(ListUM& other) {
+Alloc ListUM<T, Alloc>::get_allocator() const {
+    return allocT_;
+}
+
+template<typename T, typename Alloc>
+template<bool propagateAlloc>
+void ListUM<T, Alloc>::swap(ListUM& other) {
     std::swap(first_, other.first_);
     std::swap(last_, other.last_);
-    std::swap(alloc_, other.alloc_);
+    if constexpr (propagateAlloc) {
+        std::swap(allocT_, other.allocT_);
+        std::swap(alloc_, other.alloc_);
+    }
 }
 
 
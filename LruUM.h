@@ -0,0 +1,223 @@
+#ifndef UNORDEREDMAPTASK__LRUUM_H_
+#define UNORDEREDMAPTASK__LRUUM_H_
+
+#include <memory>
+#include "UnorderedMap.h"
+
+///
+///LruUnorderedMap: UnorderedMap with a capacity limit, entries carry an intrusive recency link,
+///a full map evicts the least recently used entry and reuses its node for the new one
+///
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>,
+         typename Equal = std::equal_to<Key>, typename Alloc = std::allocator<std::pair<const Key, Value>>>
+class LruUnorderedMap {
+public:
+    explicit LruUnorderedMap(size_t capacity, const Alloc& alloc = Alloc());
+    LruUnorderedMap(const LruUnorderedMap& other) = delete;
+    LruUnorderedMap& operator=(const LruUnorderedMap& other) = delete;
+
+    Value* get(const Key& key);
+    bool put(const Key& key, const Value& value);
+    size_t erase(const Key& key);
+    size_t count(const Key& key) const;
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const;
+    size_t hits() const;
+    size_t misses() const;
+    size_t evictions() const;
+    size_t bucket_count() const;
+    size_t longest_chain() const;
+
+private:
+    struct Slot_;
+    typedef std::pair<const Key, Slot_> Entry_;
+    struct Slot_ {
+        Value value;
+        Entry_* prev;
+        Entry_* next;
+
+        explicit Slot_(const Value& value) : value(value), prev(nullptr), next(nullptr) {
+        };
+    };
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Entry_> EntryAlloc_;
+    typedef UnorderedMap<Key, Slot_, Hash, Equal, EntryAlloc_> Map_;
+
+    Map_ map_;
+    Entry_* first_;
+    Entry_* last_;
+    size_t capacity_;
+    size_t hits_;
+    size_t misses_;
+    size_t evictions_;
+
+    void unlink_(Entry_* entry);
+    void pushFront_(Entry_* entry);
+};
+
+
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::LruUnorderedMap(size_t capacity, const Alloc& alloc)
+        : map_(8, EntryAlloc_(alloc)),
+          first_(nullptr),
+          last_(nullptr),
+          capacity_(capacity),
+          hits_(0),
+          misses_(0),
+          evictions_(0) {
+    if (capacity_ > 0) {
+        map_.reserve(capacity_);
+    }
+}
+
+///-----
+///Cache
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Value* LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::get(const Key& key) {
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+
+    ++hits_;
+    Entry_* entry = &*it;
+    if (entry != first_) {
+        unlink_(entry);
+        pushFront_(entry);
+    }
+
+    return &entry->second.value;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+bool LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::put(const Key& key, const Value& value) {
+    auto it = map_.find(key);
+    if (it != map_.end()) {
+        Entry_* entry = &*it;
+        entry->second.value = value;
+        if (entry != first_) {
+            unlink_(entry);
+            pushFront_(entry);
+        }
+        return false;
+    }
+
+    if (capacity_ == 0) {
+        return false;
+    }
+
+    if (map_.size() < capacity_) {
+        pushFront_(&*map_.emplace(key, Slot_(value)).first);
+        return true;
+    }
+
+    // Evict the least recently used entry and build the new one in its node.
+    Entry_* victim = last_;
+    unlink_(victim);
+    auto node = map_.extractListNode_(victim->first);
+    map_.mainList_.reuseNode(node, key, Slot_(value));
+    map_.insertNew_(node);
+    pushFront_(node->key);
+    ++evictions_;
+
+    return true;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const Key& key) {
+    auto it = map_.find(key);
+    if (it == map_.end()) {
+        return 0;
+    }
+
+    unlink_(&*it);
+    map_.erase(it);
+    return 1;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::count(const Key& key) const {
+    return map_.find(key) != map_.end() ? 1 : 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::clear() {
+    map_.clear();
+    first_ = nullptr;
+    last_ = nullptr;
+}
+
+///-----
+///Capacity and counters
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::size() const {
+    return map_.size();
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::capacity() const {
+    return capacity_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::hits() const {
+    return hits_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::misses() const {
+    return misses_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::evictions() const {
+    return evictions_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::bucket_count() const {
+    return map_.bucket_count();
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::longest_chain() const {
+    return map_.longest_chain();
+}
+
+///-----
+///Recency list
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::unlink_(Entry_* entry) {
+    Entry_* prev = entry->second.prev;
+    Entry_* next = entry->second.next;
+    if (prev != nullptr) {
+        prev->second.next = next;
+    } else {
+        first_ = next;
+    }
+    if (next != nullptr) {
+        next->second.prev = prev;
+    } else {
+        last_ = prev;
+    }
+    entry->second.prev = nullptr;
+    entry->second.next = nullptr;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void LruUnorderedMap<Key, Value, Hash, Equal, Alloc>::pushFront_(Entry_* entry) {
+    entry->second.prev = nullptr;
+    entry->second.next = first_;
+    if (first_ != nullptr) {
+        first_->second.prev = entry;
+    } else {
+        last_ = entry;
+    }
+    first_ = entry;
+}
+
+#endif //UNORDEREDMAPTASK__LRUUM_H_
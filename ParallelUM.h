@@ -0,0 +1,147 @@
+#ifndef UNORDEREDMAPTASK__PARALLELUM_H_
+#define UNORDEREDMAPTASK__PARALLELUM_H_
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "UnorderedMap.h"
+#include "ThreadPool.h"
+
+///
+///ParallelUM: parallel algorithms over disjoint bucket ranges of UnorderedMap
+///
+
+class ParallelUM {
+public:
+    template<typename Map, typename F>
+    static void forEach(Map& map, F& f, ThreadPool& pool);
+
+    template<typename Map, typename T, typename Op, typename Combine>
+    static T reduce(const Map& map, T init, Op& op, Combine& combine, const T& identity, ThreadPool& pool);
+
+    template<typename Map, typename Pred>
+    static size_t eraseIf(Map& map, Pred& pred, ThreadPool& pool);
+
+private:
+    static size_t numChunks_(size_t numBuckets, const ThreadPool& pool);
+
+    template<typename Map, typename F>
+    static void forBucketRanges_(Map& map, size_t numChunks, ThreadPool& pool, F&& f);
+};
+
+
+
+inline size_t ParallelUM::numChunks_(size_t numBuckets, const ThreadPool& pool) {
+    return std::min(numBuckets, pool.size() * 4);
+}
+
+template<typename Map, typename F>
+void ParallelUM::forBucketRanges_(Map& map, size_t numChunks, ThreadPool& pool, F&& f) {
+    size_t numBuckets = map.numBuckets_;
+    pool.run(numChunks, [&](size_t chunk) {
+        f(chunk, numBuckets * chunk / numChunks, numBuckets * (chunk + 1) / numChunks);
+    });
+}
+
+template<typename Map, typename F>
+void ParallelUM::forEach(Map& map, F& f, ThreadPool& pool) {
+    forBucketRanges_(map, numChunks_(map.numBuckets_, pool), pool, [&](size_t, size_t from, size_t to) {
+        for (size_t b = from; b < to; ++b) {
+            auto it = map.buckets_[b].first;
+            for (size_t i = 0; i < map.buckets_[b].second; ++i, ++it) {
+                f(*it);
+            }
+        }
+    });
+}
+
+template<typename Map, typename T, typename Op, typename Combine>
+T ParallelUM::reduce(const Map& map, T init, Op& op, Combine& combine, const T& identity, ThreadPool& pool) {
+    size_t numChunks = numChunks_(map.numBuckets_, pool);
+    std::vector<T> partials(numChunks, identity);
+
+    // Every chunk starts from the identity of combine, init is folded in exactly once below.
+    forBucketRanges_(map, numChunks, pool, [&](size_t chunk, size_t from, size_t to) {
+        T partial = identity;
+        for (size_t b = from; b < to; ++b) {
+            auto it = map.buckets_[b].first;
+            for (size_t i = 0; i < map.buckets_[b].second; ++i, ++it) {
+                partial = op(std::move(partial), static_cast<const typename Map::NodeType&>(*it));
+            }
+        }
+        partials[chunk] = std::move(partial);
+    });
+
+    for (auto& partial : partials) {
+        init = combine(std::move(init), std::move(partial));
+    }
+    return init;
+}
+
+template<typename Map, typename Pred>
+size_t ParallelUM::eraseIf(Map& map, Pred& pred, ThreadPool& pool) {
+    typedef typename Map::ListIterator_ ListIterator;
+    size_t numChunks = numChunks_(map.numBuckets_, pool);
+    std::vector<std::vector<ListIterator>> erased(numChunks);
+
+    // Buckets of a chunk belong to one thread only, so their heads and counts are fixed up in place.
+    // Neighbouring list nodes may belong to other chunks, so the unlinking itself is done afterwards.
+    forBucketRanges_(map, numChunks, pool, [&](size_t chunk, size_t from, size_t to) {
+        for (size_t b = from; b < to; ++b) {
+            auto it = map.buckets_[b].first;
+            ListIterator newFirst;
+            size_t newCount = 0;
+            for (size_t i = 0; i < map.buckets_[b].second; ++i, ++it) {
+                if (pred(static_cast<const typename Map::NodeType&>(*it))) {
+                    erased[chunk].push_back(it);
+                } else {
+                    if (newCount == 0) {
+                        newFirst = it;
+                    }
+                    ++newCount;
+                }
+            }
+            map.buckets_[b].first = newFirst;
+            map.buckets_[b].second = newCount;
+        }
+    });
+
+    size_t numErased = 0;
+    for (auto& chunk : erased) {
+        for (auto& it : chunk) {
+            map.mainList_.erase(it);
+        }
+        numErased += chunk.size();
+    }
+    map.size_ -= numErased;
+    map.filterErased_(numErased);
+
+    return numErased;
+}
+
+///-----
+///Algorithms
+///-----
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc, typename F>
+void parallel_for_each(UnorderedMap<Key, Value, Hash, Equal, Alloc>& map, F f,
+                       ThreadPool& pool = ThreadPool::global()) {
+    ParallelUM::forEach(map, f, pool);
+}
+
+///op folds one node into a chunk's partial, combine merges partials and identity must satisfy
+///combine(identity, x) == x, e.g. T() for std::plus, T(1) for std::multiplies
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc,
+         typename T, typename Op, typename Combine>
+T parallel_reduce(const UnorderedMap<Key, Value, Hash, Equal, Alloc>& map, T init, Op op, Combine combine,
+                  const T& identity, ThreadPool& pool = ThreadPool::global()) {
+    return ParallelUM::reduce(map, std::move(init), op, combine, identity, pool);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc, typename Pred>
+size_t parallel_erase_if(UnorderedMap<Key, Value, Hash, Equal, Alloc>& map, Pred pred,
+                         ThreadPool& pool = ThreadPool::global()) {
+    return ParallelUM::eraseIf(map, pred, pool);
+}
+
+#endif //UNORDEREDMAPTASK__PARALLELUM_H_
@@ -0,0 +1,166 @@
+#ifndef UNORDEREDMAPTASK__THREADPOOL_H_
+#define UNORDEREDMAPTASK__THREADPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+
+///
+///ThreadPool: fork-join pool, run(n, f) calls f(0..n-1) on the workers and the calling thread,
+///a run() nested inside a task of the same pool executes inline on the calling thread
+///
+
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t numThreads = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool& other) = delete;
+    ~ThreadPool();
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    size_t size() const;
+
+    template<typename F>
+    void run(size_t numTasks, F&& f);
+
+    static ThreadPool& global();
+
+private:
+    std::vector<std::thread> workers_;
+    std::mutex runMutex_;
+    std::mutex mutex_;
+    std::condition_variable taskCv_;
+    std::condition_variable doneCv_;
+
+    std::function<void(size_t)> task_;
+    size_t numTasks_;
+    size_t nextTask_;
+    size_t doneTasks_;
+    size_t generation_;
+    std::exception_ptr error_;
+    bool stop_;
+
+    void work_();
+    void runTasks_(std::unique_lock<std::mutex>& lock);
+    static const ThreadPool*& current_();
+};
+
+
+
+inline ThreadPool::ThreadPool(size_t numThreads)
+        : numTasks_(0),
+          nextTask_(0),
+          doneTasks_(0),
+          generation_(0),
+          error_(nullptr),
+          stop_(false) {
+    for (size_t i = 1; i < numThreads; ++i) {
+        workers_.emplace_back(&ThreadPool::work_, this);
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    taskCv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+inline size_t ThreadPool::size() const {
+    return workers_.size() + 1;
+}
+
+inline ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+template<typename F>
+void ThreadPool::run(size_t numTasks, F&& f) {
+    if (numTasks == 0) {
+        return;
+    }
+
+    // Waiting for runMutex_ from inside one of our own tasks would never return.
+    if (current_() == this) {
+        for (size_t i = 0; i < numTasks; ++i) {
+            f(i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(runMutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    task_ = [&f](size_t i) {
+        f(i);
+    };
+    numTasks_ = numTasks;
+    nextTask_ = 0;
+    doneTasks_ = 0;
+    error_ = nullptr;
+    ++generation_;
+    taskCv_.notify_all();
+
+    runTasks_(lock);
+    doneCv_.wait(lock, [this] {
+        return doneTasks_ == numTasks_;
+    });
+
+    task_ = nullptr;
+    if (error_ != nullptr) {
+        std::rethrow_exception(error_);
+    }
+}
+
+inline void ThreadPool::work_() {
+    size_t seenGeneration = 0;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        taskCv_.wait(lock, [this, seenGeneration] {
+            return stop_ || generation_ != seenGeneration;
+        });
+        if (stop_) {
+            return;
+        }
+
+        seenGeneration = generation_;
+        runTasks_(lock);
+    }
+}
+
+inline void ThreadPool::runTasks_(std::unique_lock<std::mutex>& lock) {
+    while (nextTask_ < numTasks_) {
+        size_t i = nextTask_++;
+        lock.unlock();
+        const ThreadPool* outer = current_();
+        current_() = this;
+        try {
+            task_(i);
+        } catch (...) {
+            lock.lock();
+            if (error_ == nullptr) {
+                error_ = std::current_exception();
+            }
+            lock.unlock();
+        }
+        current_() = outer;
+        lock.lock();
+
+        if (++doneTasks_ == numTasks_) {
+            doneCv_.notify_all();
+        }
+    }
+}
+
+inline const ThreadPool*& ThreadPool::current_() {
+    thread_local const ThreadPool* current = nullptr;
+    return current;
+}
+
+#endif //UNORDEREDMAPTASK__THREADPOOL_H_
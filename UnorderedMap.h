@@ -5,11 +5,27 @@
 #include <string>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <stdexcept>
+#include <atomic>
 #include "ListUM.h"
+#include "HashMix.h"
+#include "BloomFilter.h"
+
+class ParallelUM;
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+class LruUnorderedMap;
 
 ///
 ///UnorderedMap
 ///
+///Chains longer than max_chain_length() trigger a reseeded rehash. Keys that share one full hash value
+///cannot be separated by any seed: their chain stays linear and lookups among them remain O(n),
+///longest_chain() reports it, scanning the buckets on each call. Hash functions exposed to adversarial
+///keys should be keyed.
+///
 
 template<typename Key, typename Value, typename Hash = std::hash<Key>,
          typename Equal = std::equal_to<Key>, typename Alloc = std::allocator<std::pair<const Key, Value>>>
@@ -17,8 +33,9 @@ class UnorderedMap {
 public:
     typedef std::pair<const Key, Value> NodeType;
 
-    explicit UnorderedMap(size_t numBuckets = 8);
+    explicit UnorderedMap(size_t numBuckets = 8, const Alloc& alloc = Alloc());
     UnorderedMap(const UnorderedMap& other);
+    UnorderedMap(const UnorderedMap& other, const Alloc& alloc);
     UnorderedMap(UnorderedMap&& other) noexcept;
     ~UnorderedMap();
     UnorderedMap& operator=(const UnorderedMap& other);
@@ -33,6 +50,7 @@ public:
         explicit HelpIterator(ListIterator_ it) : iter_(it) {
         };
         friend class UnorderedMap;
+        template<bool> friend class HelpIterator;
 
     public:
         typedef std::forward_iterator_tag iterator_category;
@@ -42,6 +60,9 @@ public:
         typedef typename std::conditional<is_const, const NodeType&, NodeType&>::type reference;
 
         HelpIterator(const HelpIterator& other);
+        template<bool other_const, typename = typename std::enable_if<is_const && !other_const>::type>
+        HelpIterator(const HelpIterator<other_const>& other) : iter_(other.iter_) {
+        };
         HelpIterator& operator=(const HelpIterator& other);
 
         reference operator*() const;
@@ -67,14 +88,18 @@ public:
     const Value& at(const Key& key) const;
     Value& at(const Key& key);
     Iterator find(const Key& key);
+    ConstIterator find(const Key& key) const;
 
-    size_t size();
+    size_t size() const;
     void rehash(size_t count);
     void reserve(size_t count);
     size_t max_size() const;
     float max_load_factor() const;
     void max_load_factor(float ml);
     float load_factor() const;
+    size_t max_chain_length() const;
+    void max_chain_length(size_t length);
+    size_t longest_chain() const;
 
     std::pair<Iterator, bool> insert(NodeType&& node);
     std::pair<Iterator, bool> insert(const NodeType& node);
@@ -88,71 +113,143 @@ public:
 
     void erase(Iterator it);
     void erase(Iterator begin, Iterator end);
+    size_t erase(const Key& key);
+    template<typename Pred>
+    size_t erase_if(Pred pred);
+    void clear();
+
+    template<typename Combine>
+    void merge(UnorderedMap& other, Combine combine);
+
+    size_t bucket_count() const;
+    size_t bucket_size(size_t n) const;
+
+    Alloc get_allocator() const;
+    void swap(UnorderedMap& other);
+    size_t memory_usage() const;
+    size_t memory_budget() const;
+    void memory_budget(size_t bytes);
+    bool membership_filter() const;
+    void membership_filter(bool enable);
+    float filter_false_positive_rate() const;
+    size_t filter_memory_usage() const;
 
 private:
     typedef typename ListUM<NodeType, Alloc>::Iterator ListIterator_;
     typedef typename ListUM<NodeType, Alloc>::Node ListNode_;
     typedef std::pair<ListIterator_, size_t> TypeBucket_;
+    typedef std::allocator_traits<Alloc> AllocTraits_;
+    typedef typename AllocTraits_::template rebind_alloc<TypeBucket_> BucketAlloc_;
+    typedef std::allocator_traits<BucketAlloc_> BucketAllocTraits_;
     size_t numBuckets_;
     size_t size_;
     float maxLoadFactor_;
+    size_t maxChainLength_;
+    size_t chainLimit_;
+    size_t longestChain_;
+    size_t seed_;
+    size_t memoryBudget_;
+    bool filterEnabled_;
+    BloomFilter<Alloc> filter_;
+    size_t filterStale_;
+    mutable std::atomic<size_t> filterNegatives_;
+    mutable std::atomic<size_t> filterFalsePositives_;
     ListUM<NodeType, Alloc> mainList_;
-    typename Alloc::template rebind<TypeBucket_>::other bucketAlloc_;
+    BucketAlloc_ bucketAlloc_;
     TypeBucket_* buckets_;
     Hash hash;
     Equal equal;
 
+    size_t bucketIndex_(const Key& key) const;
+    size_t bucketOfHash_(size_t keyHash) const;
+    ListIterator_ findNode_(const Key& key, bool isLookup = false) const;
+    void reserveNode_();
     template<typename T>
     auto insertHelp_(T&& node);
-    void insertListNode_(ListNode_* node);
+    std::pair<Iterator, bool> insertNew_(ListNode_* node);
+    ListIterator_ insertListNode_(ListNode_* node);
+    ListNode_* extractListNode_(const Key& key);
 
     void checkLoadFactor_();
+    void checkChainLength_();
+    void filterAdd_(const Key& key);
+    void filterErased_(size_t count);
+    size_t filterCapacity_(size_t numKeys) const;
+    void rebuildFilter_();
+    void copySettings_(const UnorderedMap& other);
+    template<bool propagateAlloc>
     void swap_(UnorderedMap& other);
+
+    friend class ParallelUM;
+    template<typename, typename, typename, typename, typename> friend class LruUnorderedMap;
 };
 
 
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-UnorderedMap<Key, Value, Hash, Equal, Alloc>::UnorderedMap(size_t numBuckets)
+UnorderedMap<Key, Value, Hash, Equal, Alloc>::UnorderedMap(size_t numBuckets, const Alloc& alloc)
         : numBuckets_(numBuckets),
           size_(0),
           maxLoadFactor_(0.75),
-          mainList_(),
-          bucketAlloc_(),
-          buckets_(bucketAlloc_.allocate(numBuckets_)),
+          maxChainLength_(16),
+          chainLimit_(maxChainLength_),
+          longestChain_(0),
+          seed_(0),
+          memoryBudget_(std::numeric_limits<size_t>::max()),
+          filterEnabled_(false),
+          filter_(alloc),
+          filterStale_(0),
+          filterNegatives_(0),
+          filterFalsePositives_(0),
+          mainList_(alloc),
+          bucketAlloc_(alloc),
+          buckets_(BucketAllocTraits_::allocate(bucketAlloc_, numBuckets_)),
           hash(),
           equal() {
     for (size_t i = 0; i < numBuckets_; ++i) {
-        bucketAlloc_.construct(buckets_ + i);
+        BucketAllocTraits_::construct(bucketAlloc_, buckets_ + i);
     }
 }
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 UnorderedMap<Key, Value, Hash, Equal, Alloc>::UnorderedMap(const UnorderedMap& other)
+        : UnorderedMap(other, AllocTraits_::select_on_container_copy_construction(other.get_allocator())) {
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+UnorderedMap<Key, Value, Hash, Equal, Alloc>::UnorderedMap(const UnorderedMap& other, const Alloc& alloc)
         : numBuckets_(other.numBuckets_),
           size_(other.size_),
           maxLoadFactor_(other.maxLoadFactor_),
-          mainList_(other.mainList_),
-          bucketAlloc_(other.bucketAlloc_),
-          buckets_(bucketAlloc_.allocate(numBuckets_)),
+          maxChainLength_(other.maxChainLength_),
+          chainLimit_(other.chainLimit_),
+          longestChain_(other.longestChain_),
+          seed_(other.seed_),
+          memoryBudget_(other.memoryBudget_),
+          filterEnabled_(other.filterEnabled_),
+          filter_(other.filter_, alloc),
+          filterStale_(other.filterStale_),
+          filterNegatives_(other.filterNegatives_.load(std::memory_order_relaxed)),
+          filterFalsePositives_(other.filterFalsePositives_.load(std::memory_order_relaxed)),
+          mainList_(alloc),
+          bucketAlloc_(alloc),
+          buckets_(BucketAllocTraits_::allocate(bucketAlloc_, numBuckets_)),
           hash(other.hash),
           equal(other.equal) {
     for (size_t i = 0; i < numBuckets_; ++i) {
-        bucketAlloc_.construct(buckets_ + i);
+        BucketAllocTraits_::construct(bucketAlloc_, buckets_ + i);
     }
 
-    if (size_ > 0) {
-        size_t prevHash = -1;
-        size_t thisHash;
-        for (auto it = mainList_.begin(); it != mainList_.end(); ++it) {
-            thisHash = hash(it->first) % numBuckets_;
-
-            if (thisHash != prevHash) {
-                buckets_[thisHash].first = it;
-                ++buckets_[thisHash].second;
-                prevHash = thisHash;
+    // Copying bucket by bucket keeps every bucket contiguous without hashing any key.
+    for (size_t i = 0; i < numBuckets_; ++i) {
+        auto it = other.buckets_[i].first;
+        for (size_t j = 0; j < other.buckets_[i].second; ++j, ++it) {
+            auto node = mainList_.push_back(mainList_.makeNode(*it));
+            if (j == 0) {
+                buckets_[i].first = node;
             }
         }
+        buckets_[i].second = other.buckets_[i].second;
     }
 }
 
@@ -161,6 +258,16 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::UnorderedMap(UnorderedMap&& other)
         : numBuckets_(other.numBuckets_),
           size_(other.size_),
           maxLoadFactor_(other.maxLoadFactor_),
+          maxChainLength_(other.maxChainLength_),
+          chainLimit_(other.chainLimit_),
+          longestChain_(other.longestChain_),
+          seed_(other.seed_),
+          memoryBudget_(other.memoryBudget_),
+          filterEnabled_(other.filterEnabled_),
+          filter_(std::move(other.filter_)),
+          filterStale_(other.filterStale_),
+          filterNegatives_(other.filterNegatives_.load(std::memory_order_relaxed)),
+          filterFalsePositives_(other.filterFalsePositives_.load(std::memory_order_relaxed)),
           mainList_(std::move(other.mainList_)),
           bucketAlloc_(std::move(other.bucketAlloc_)),
           buckets_(other.buckets_),
@@ -173,9 +280,9 @@ template<typename Key, typename Value, typename Hash, typename Equal, typename A
 UnorderedMap<Key, Value, Hash, Equal, Alloc>::~UnorderedMap() {
     if (buckets_ != nullptr) {
         for (size_t i = 0; i < numBuckets_; ++i) {
-            bucketAlloc_.destroy(buckets_ + i);
+            BucketAllocTraits_::destroy(bucketAlloc_, buckets_ + i);
         }
-        bucketAlloc_.deallocate(buckets_, numBuckets_);
+        BucketAllocTraits_::deallocate(bucketAlloc_, buckets_, numBuckets_);
     }
     buckets_ = nullptr;
 }
@@ -183,16 +290,29 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::~UnorderedMap() {
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 UnorderedMap<Key, Value, Hash, Equal, Alloc>&
 UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(const UnorderedMap& other) {
-    UnorderedMap tmp = other;
-    this->swap_(tmp);
+    constexpr bool propagate = AllocTraits_::propagate_on_container_copy_assignment::value;
+    UnorderedMap tmp(other, propagate ? other.get_allocator() : get_allocator());
+    this->swap_<propagate>(tmp);
 
     return *this;
 }
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 UnorderedMap<Key, Value, Hash, Equal, Alloc>&
 UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator=(UnorderedMap&& other) {
-    UnorderedMap tmp = std::move(other);
-    this->swap_(tmp);
+    constexpr bool propagate = AllocTraits_::propagate_on_container_move_assignment::value;
+    if (propagate || get_allocator() == other.get_allocator()) {
+        UnorderedMap tmp = std::move(other);
+        this->swap_<propagate>(tmp);
+    } else {
+        // Nodes cannot change owners between unequal allocators, so the elements are moved one by one.
+        UnorderedMap tmp(other.numBuckets_, get_allocator());
+        tmp.copySettings_(other);
+        for (auto it = other.mainList_.begin(); it != other.mainList_.end(); ++it) {
+            tmp.insertListNode_(tmp.mainList_.makeNode(std::move(*it)));
+        }
+        other.clear();
+        this->swap_<false>(tmp);
+    }
 
     return *this;
 }
@@ -301,15 +421,21 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::cend() const {
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::operator[](const Key& key) {
-    try {
-        return at(key);
-    } catch (std::out_of_range& e) {
-        return emplace(key, Value()).first->second;
+    auto it = find(key);
+    if (it != end()) {
+        return it->second;
     }
+
+    return emplace(key, Value()).first->second;
 }
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 const Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) const {
-    return at(key);
+    auto it = find(key);
+    if (it != end()) {
+        return it->second;
+    }
+
+    throw std::out_of_range("key not found");
 }
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) {
@@ -323,23 +449,46 @@ Value& UnorderedMap<Key, Value, Hash, Equal, Alloc>::at(const Key& key) {
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator
 UnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) {
-    size_t indexBucket = hash(key) % numBuckets_;
+    return Iterator(findNode_(key, true));
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::ConstIterator
+UnorderedMap<Key, Value, Hash, Equal, Alloc>::find(const Key& key) const {
+    return ConstIterator(Iterator(findNode_(key, true)));
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::ListIterator_
+UnorderedMap<Key, Value, Hash, Equal, Alloc>::findNode_(const Key& key, bool isLookup) const {
+    // Only lookups through find() and at() feed the filter statistics; const lookups may run concurrently,
+    // hence the relaxed atomics.
+    size_t keyHash = hash(key);
+    if (filterEnabled_ && !filter_.mayContain(keyHash)) {
+        if (isLookup) {
+            filterNegatives_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return ListIterator_();
+    }
+
+    size_t indexBucket = bucketOfHash_(keyHash);
 
     size_t i = 0;
     for (auto it = buckets_[indexBucket].first; i < buckets_[indexBucket].second; ++it, ++i) {
         if (equal(it->first, key)) {
-            return Iterator(it);
+            return it;
         }
     }
 
-    return end();
+    if (filterEnabled_ && isLookup) {
+        filterFalsePositives_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return ListIterator_();
 }
 
 ///-----
 ///Capacity and hash
 ///-----
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::size() {
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::size() const {
     return size_;
 }
 
@@ -349,8 +498,12 @@ void UnorderedMap<Key, Value, Hash, Equal, Alloc>::rehash(size_t count) {
         count = std::ceil(size_ / maxLoadFactor_);
     }
 
-    UnorderedMap<Key, Value, Hash, Equal, Alloc> newUnorderedMap(count);
-    newUnorderedMap.maxLoadFactor_ = maxLoadFactor_;
+    if (count * sizeof(TypeBucket_) + size_ * (sizeof(ListNode_) + sizeof(NodeType)) > memoryBudget_) {
+        throw std::length_error("memory budget exceeded");
+    }
+
+    UnorderedMap<Key, Value, Hash, Equal, Alloc> newUnorderedMap(count, get_allocator());
+    newUnorderedMap.copySettings_(*this);
 
     for (auto it = mainList_.begin(); it != mainList_.end();) {
         newUnorderedMap.insertListNode_(mainList_.extractNode(it++));
@@ -381,6 +534,89 @@ float UnorderedMap<Key, Value, Hash, Equal, Alloc>::load_factor() const {
     return static_cast<float>(size_) / numBuckets_;
 }
 
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::max_chain_length() const {
+    return maxChainLength_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::max_chain_length(size_t length) {
+    maxChainLength_ = length;
+    chainLimit_ = length;
+    checkChainLength_();
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::longest_chain() const {
+    size_t longest = 0;
+    for (size_t i = 0; i < numBuckets_; ++i) {
+        longest = std::max(longest, buckets_[i].second);
+    }
+
+    return longest;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::bucket_count() const {
+    return numBuckets_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::bucket_size(size_t n) const {
+    return buckets_[n].second;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+Alloc UnorderedMap<Key, Value, Hash, Equal, Alloc>::get_allocator() const {
+    return mainList_.get_allocator();
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::swap(UnorderedMap& other) {
+    swap_<AllocTraits_::propagate_on_container_swap::value>(other);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::memory_usage() const {
+    return numBuckets_ * sizeof(TypeBucket_) + size_ * (sizeof(ListNode_) + sizeof(NodeType))
+           + filter_memory_usage();
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::memory_budget() const {
+    return memoryBudget_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::memory_budget(size_t bytes) {
+    memoryBudget_ = bytes;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+bool UnorderedMap<Key, Value, Hash, Equal, Alloc>::membership_filter() const {
+    return filterEnabled_;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::membership_filter(bool enable) {
+    if (enable && filterCapacity_(size_) == 0) {
+        throw std::length_error("memory budget exceeded");
+    }
+
+    filterEnabled_ = enable;
+    filterNegatives_.store(0, std::memory_order_relaxed);
+    filterFalsePositives_.store(0, std::memory_order_relaxed);
+    if (enable) {
+        rebuildFilter_();
+    } else {
+        filter_.reset(0);
+    }
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+float UnorderedMap<Key, Value, Hash, Equal, Alloc>::filter_false_positive_rate() const {
+    // Every absent key either stops at the filter or walks its chain in vain.
+    size_t falsePositives = filterFalsePositives_.load(std::memory_order_relaxed);
+    size_t absent = filterNegatives_.load(std::memory_order_relaxed) + falsePositives;
+    return absent == 0 ? 0 : static_cast<float>(falsePositives) / absent;
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::filter_memory_usage() const {
+    return filterEnabled_ ? filter_.memory_usage() : 0;
+}
+
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 void UnorderedMap<Key, Value, Hash, Equal, Alloc>::checkLoadFactor_() {
     if (maxLoadFactor_ < load_factor()) {
@@ -388,47 +624,162 @@ void UnorderedMap<Key, Value, Hash, Equal, Alloc>::checkLoadFactor_() {
     }
 }
 
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::checkChainLength_() {
+    if (longestChain_ <= chainLimit_) {
+        return;
+    }
+
+    // longestChain_ is the peak since the last rehash or clear, erases do not lower it; it only decides
+    // when to reseed, longest_chain() counts the buckets instead.
+    // A chain this long under a sane load factor means the hash keeps colliding modulo numBuckets_:
+    // mix it with a fresh seed and redistribute. If the chain survives that, the keys share a full
+    // hash value and reseeding cannot help, so stop retrying until the chain doubles again. Such a chain
+    // is still scanned linearly; equal hashes give no order to search by.
+    seed_ = std::random_device()() | 1;
+    rehash(numBuckets_);
+    if (longestChain_ > chainLimit_) {
+        chainLimit_ = longestChain_ * 2;
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::bucketIndex_(const Key& key) const {
+    return bucketOfHash_(hash(key));
+}
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::bucketOfHash_(size_t keyHash) const {
+    if (seed_ == 0) {
+        return keyHash % numBuckets_;
+    }
+
+    return mixHash(keyHash ^ seed_) % numBuckets_;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::filterAdd_(const Key& key) {
+    if (!filterEnabled_) {
+        return;
+    }
+
+    if (size_ > filter_.capacity()) {
+        rebuildFilter_();
+    } else {
+        filter_.add(hash(key));
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::filterErased_(size_t count) {
+    if (!filterEnabled_) {
+        return;
+    }
+
+    // A Bloom filter cannot drop keys, erased ones only cost false positives. The filter is rebuilt
+    // once they reach a quarter of the live keys, each rebuild is paid for by that many erases.
+    // A budget too tight for the rebuild keeps the stale filter, which still holds every live key.
+    filterStale_ += count;
+    if (filterStale_ * 4 > size_ && filterCapacity_(size_) != 0) {
+        rebuildFilter_();
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::filterCapacity_(size_t numKeys) const {
+    // Room for twice the keys, so a growing map rebuilds only each time it doubles. A tight budget gets
+    // room for the keys alone, 0 means not even that fits next to the buckets and nodes.
+    size_t rest = numBuckets_ * sizeof(TypeBucket_) + numKeys * (sizeof(ListNode_) + sizeof(NodeType));
+    for (size_t capacity : {std::max<size_t>(numKeys * 2, 16), std::max<size_t>(numKeys, 16)}) {
+        if (rest + filter_.memoryFor(capacity) <= memoryBudget_) {
+            return capacity;
+        }
+    }
+
+    return 0;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::rebuildFilter_() {
+    if (!filterEnabled_) {
+        return;
+    }
+
+    size_t capacity = filterCapacity_(size_);
+    if (capacity == 0) {
+        throw std::length_error("memory budget exceeded");
+    }
+    filter_.reset(capacity);
+    for (auto it = mainList_.begin(); it != mainList_.end(); ++it) {
+        filter_.add(hash(it->first));
+    }
+    filterStale_ = 0;
+}
+
 ///-----
 ///Modifiers
 ///-----
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-void UnorderedMap<Key, Value, Hash, Equal, Alloc>::insertListNode_(ListNode_* node) {
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::ListIterator_
+UnorderedMap<Key, Value, Hash, Equal, Alloc>::insertListNode_(ListNode_* node) {
     checkLoadFactor_();
 
-    size_t indexBucket = hash(node->key->first) % numBuckets_;
+    ListIterator_ it;
+    size_t indexBucket = bucketIndex_(node->key->first);
     if (buckets_[indexBucket].second > 0) {
-        mainList_.insert_after(buckets_[indexBucket].first, node);
+        it = mainList_.insert_after(buckets_[indexBucket].first, node);
     } else {
-        buckets_[indexBucket].first = mainList_.push_front(node);
+        it = mainList_.push_front(node);
+        buckets_[indexBucket].first = it;
     }
 
     ++buckets_[indexBucket].second;
+    longestChain_ = std::max(longestChain_, buckets_[indexBucket].second);
     ++size_;
+    filterAdd_(node->key->first);
+
+    return it;
 }
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
-template<typename T>
-auto UnorderedMap<Key, Value, Hash, Equal, Alloc>::insertHelp_(T&& node) {
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::reserveNode_() {
+    // Grow first, so that neither the bucket array nor the node is allocated past the budget. A full filter
+    // is rebuilt by this insert, it must fit with room for at least the keys, or the key would be missing.
     checkLoadFactor_();
+    size_t filterBytes = filter_memory_usage();
+    if (filterEnabled_ && size_ + 1 > filter_.capacity()) {
+        filterBytes = filter_.memoryFor(std::max<size_t>(size_ + 1, 16));
+    }
+    if (memory_usage() - filter_memory_usage() + filterBytes + sizeof(ListNode_) + sizeof(NodeType) > memoryBudget_) {
+        throw std::length_error("memory budget exceeded");
+    }
+}
 
-    auto it = find(node->key->first);
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename T>
+auto UnorderedMap<Key, Value, Hash, Equal, Alloc>::insertHelp_(T&& node) {
+    // The key is only known once the node is built, the budget applies only if the key turns out new.
+    Iterator it(findNode_(node->key->first));
     if (it != end()) {
         mainList_.delNode(node);
-        return std::pair<UnorderedMap::Iterator, bool>(it, false);
+        return std::pair<Iterator, bool>(it, false);
     }
 
-    size_t indexBucket = hash(node->key->first) % numBuckets_;
-
-    if (buckets_[indexBucket].second > 0) {
-        it = Iterator(mainList_.insert_after(buckets_[indexBucket].first, node));
-    } else {
-        buckets_[indexBucket].first = mainList_.push_front(node);
-        it = Iterator(buckets_[indexBucket].first);
+    try {
+        reserveNode_();
+    } catch (...) {
+        mainList_.delNode(node);
+        throw;
     }
 
-    ++buckets_[indexBucket].second;
-    ++size_;
+    return insertNew_(node);
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator, bool>
+UnorderedMap<Key, Value, Hash, Equal, Alloc>::insertNew_(ListNode_* node) {
+    Iterator it(insertListNode_(node));
+    checkChainLength_();
 
     return std::pair<Iterator, bool>(it, true);
 }
@@ -436,12 +787,24 @@ auto UnorderedMap<Key, Value, Hash, Equal, Alloc>::insertHelp_(T&& node) {
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator, bool>
 UnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(UnorderedMap::NodeType&& node) {
-    return insertHelp_(mainList_.makeNode(std::move(node)));
+    Iterator it(findNode_(node.first));
+    if (it != end()) {
+        return std::pair<Iterator, bool>(it, false);
+    }
+
+    reserveNode_();
+    return insertNew_(mainList_.makeNode(std::move(node)));
 }
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 std::pair<typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::Iterator, bool>
 UnorderedMap<Key, Value, Hash, Equal, Alloc>::insert(const UnorderedMap::NodeType& node) {
-    return insertHelp_(mainList_.makeNode(node));
+    Iterator it(findNode_(node.first));
+    if (it != end()) {
+        return std::pair<Iterator, bool>(it, false);
+    }
+
+    reserveNode_();
+    return insertNew_(mainList_.makeNode(node));
 }
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 template<typename T>
@@ -467,29 +830,218 @@ UnorderedMap<Key, Value, Hash, Equal, Alloc>::emplace(Args&& ... args) {
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 void UnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(UnorderedMap::Iterator it) {
-    size_t indexBucket = hash(it->first) % numBuckets_;
+    size_t indexBucket = bucketIndex_(it->first);
     if (buckets_[indexBucket].first == it.iter_) {
         ++buckets_[indexBucket].first;
     }
     mainList_.erase(it.iter_);
     --buckets_[indexBucket].second;
     --size_;
+    filterErased_(1);
 }
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
 void UnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(UnorderedMap::Iterator begin, UnorderedMap::Iterator end) {
-    for (Iterator it = begin; it != end;) {
-        erase(it++);
+    ListIterator_ it = begin.iter_;
+    while (it != end.iter_) {
+        // Nodes of a bucket are contiguous in mainList_, so the key is hashed once per bucket run;
+        // only the first run may start in the middle of its bucket.
+        TypeBucket_& bucket = buckets_[bucketIndex_(it->first)];
+        size_t offset = 0;
+        for (ListIterator_ first = bucket.first; first != it; ++first) {
+            ++offset;
+        }
+
+        size_t erased = 0;
+        while (offset + erased < bucket.second && it != end.iter_) {
+            mainList_.erase(it++);
+            ++erased;
+        }
+
+        if (offset == 0) {
+            bucket.first = it;
+        }
+        bucket.second -= erased;
+        size_ -= erased;
+        filterErased_(erased);
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::erase(const Key& key) {
+    ListNode_* node = extractListNode_(key);
+    if (node == nullptr) {
+        return 0;
+    }
+
+    mainList_.delNode(node);
+    return 1;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+typename UnorderedMap<Key, Value, Hash, Equal, Alloc>::ListNode_*
+UnorderedMap<Key, Value, Hash, Equal, Alloc>::extractListNode_(const Key& key) {
+    TypeBucket_& bucket = buckets_[bucketIndex_(key)];
+
+    auto it = bucket.first;
+    for (size_t i = 0; i < bucket.second; ++it, ++i) {
+        if (equal(it->first, key)) {
+            if (i == 0) {
+                ++bucket.first;
+            }
+            --bucket.second;
+            --size_;
+            ListNode_* node = mainList_.extractNode(it);
+            filterErased_(1);
+            return node;
+        }
     }
+
+    return nullptr;
 }
 
 template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename Pred>
+size_t UnorderedMap<Key, Value, Hash, Equal, Alloc>::erase_if(Pred pred) {
+    size_t numErased = 0;
+    for (size_t indexBucket = 0; indexBucket < numBuckets_; ++indexBucket) {
+        TypeBucket_& bucket = buckets_[indexBucket];
+
+        auto it = bucket.first;
+        size_t count = bucket.second;
+        for (size_t i = 0; i < count; ++i) {
+            if (pred(static_cast<const NodeType&>(*it))) {
+                if (it == bucket.first) {
+                    ++bucket.first;
+                }
+                mainList_.erase(it++);
+                --bucket.second;
+                ++numErased;
+            } else {
+                ++it;
+            }
+        }
+    }
+    size_ -= numErased;
+    filterErased_(numErased);
+
+    return numErased;
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::clear() {
+    mainList_.clear();
+    for (size_t i = 0; i < numBuckets_; ++i) {
+        buckets_[i] = TypeBucket_();
+    }
+    size_ = 0;
+    longestChain_ = 0;
+    chainLimit_ = maxChainLength_;
+    if (filterEnabled_) {
+        filter_.clear();
+        filterStale_ = 0;
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<typename Combine>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::merge(UnorderedMap& other, Combine combine) {
+    if (&other == this) {
+        return;
+    }
+
+    // Values of existing keys are combined. Nodes with new keys are relinked when both maps share an
+    // allocator, otherwise their elements move into nodes of this map's allocator. Every node leaves its
+    // bucket in other only once its element is safe in this map, so a budget error or a throwing combine
+    // leaves both maps valid, with the unmerged rest still in other.
+    bool relink = get_allocator() == other.get_allocator();
+    for (size_t indexBucket = 0; indexBucket < other.numBuckets_; ++indexBucket) {
+        TypeBucket_& bucket = other.buckets_[indexBucket];
+        while (bucket.second > 0) {
+            ListIterator_ it = bucket.first;
+            ListIterator_ found = findNode_(it->first);
+            ListNode_* node = nullptr;
+            if (found != ListIterator_()) {
+                found->second = combine(std::move(found->second), std::move(it->second));
+            } else {
+                reserveNode_();
+                if (!relink) {
+                    node = mainList_.makeNode(std::move(*it));
+                }
+            }
+
+            ++bucket.first;
+            --bucket.second;
+            --other.size_;
+            ListNode_* otherNode = other.mainList_.extractNode(it);
+            other.filterErased_(1);
+
+            if (found != ListIterator_()) {
+                other.mainList_.delNode(otherNode);
+            } else if (relink) {
+                insertListNode_(otherNode);
+            } else {
+                other.mainList_.delNode(otherNode);
+                insertListNode_(node);
+            }
+        }
+    }
+    other.clear();
+    checkChainLength_();
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+void UnorderedMap<Key, Value, Hash, Equal, Alloc>::copySettings_(const UnorderedMap& other) {
+    maxLoadFactor_ = other.maxLoadFactor_;
+    maxChainLength_ = other.maxChainLength_;
+    chainLimit_ = other.maxChainLength_;
+    seed_ = other.seed_;
+    memoryBudget_ = other.memoryBudget_;
+    hash = other.hash;
+    equal = other.equal;
+
+    // Counters carry over, the filter itself is refilled as the nodes are relinked.
+    filterEnabled_ = other.filterEnabled_;
+    filterNegatives_.store(other.filterNegatives_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    filterFalsePositives_.store(other.filterFalsePositives_.load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+    if (filterEnabled_) {
+        // Sized for everything other holds, so relinking its nodes never triggers a rebuild; checked against
+        // the budget before any node moves.
+        size_t capacity = filterCapacity_(other.size_);
+        if (capacity == 0) {
+            throw std::length_error("memory budget exceeded");
+        }
+        filter_.reset(capacity);
+        filterStale_ = 0;
+    }
+}
+
+template<typename Key, typename Value, typename Hash, typename Equal, typename Alloc>
+template<bool propagateAlloc>
 void UnorderedMap<Key, Value, Hash, Equal, Alloc>::swap_(UnorderedMap& other) {
     std::swap(numBuckets_, other.numBuckets_);
     std::swap(size_, other.size_);
     std::swap(maxLoadFactor_, other.maxLoadFactor_);
-    std::swap(mainList_, other.mainList_);
-    std::swap(bucketAlloc_, other.bucketAlloc_);
+    std::swap(maxChainLength_, other.maxChainLength_);
+    std::swap(chainLimit_, other.chainLimit_);
+    std::swap(longestChain_, other.longestChain_);
+    std::swap(seed_, other.seed_);
+    std::swap(memoryBudget_, other.memoryBudget_);
+    std::swap(filterEnabled_, other.filterEnabled_);
+    filter_.template swap<propagateAlloc>(other.filter_);
+    std::swap(filterStale_, other.filterStale_);
+    size_t negatives = filterNegatives_.load(std::memory_order_relaxed);
+    filterNegatives_.store(other.filterNegatives_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    other.filterNegatives_.store(negatives, std::memory_order_relaxed);
+    size_t falsePositives = filterFalsePositives_.load(std::memory_order_relaxed);
+    filterFalsePositives_.store(other.filterFalsePositives_.load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+    other.filterFalsePositives_.store(falsePositives, std::memory_order_relaxed);
+    mainList_.template swap<propagateAlloc>(other.mainList_);
+    if constexpr (propagateAlloc) {
+        std::swap(bucketAlloc_, other.bucketAlloc_);
+    }
     std::swap(buckets_, other.buckets_);
     std::swap(hash, other.hash);
     std::swap(equal, other.equal);
@@ -1,9 +1,295 @@
 #include <iostream>
 #include "UnorderedMap.h"
+#include "ParallelUM.h"
+#include "LruUM.h"
+#include "CuckooUM.h"
 #include <vector>
 #include <string>
 #include <cassert>
+#include <random>
+#include <functional>
+#include <atomic>
+#include <unordered_map>
+#include <stdexcept>
+
+///-----
+///UnorderedMap
+///-----
+
+struct ConstantHash {
+    size_t operator()(long) const {
+        return 0;
+    }
+};
+
+void testLongestChain() {
+    UnorderedMap<long, int, ConstantHash> map;
+    for (long i = 0; i < 100; ++i) {
+        map.emplace(i, 1);
+    }
+    assert(map.longest_chain() == 100);
+
+    for (long i = 0; i < 50; ++i) {
+        map.erase(i);
+    }
+    assert(map.longest_chain() == 50);
+
+    map.clear();
+    assert(map.longest_chain() == 0);
+}
+
+void testFilterBudget() {
+    UnorderedMap<long, long> map;
+    for (long i = 0; i < 1000; ++i) {
+        map.emplace(i, i);
+    }
+
+    map.memory_budget(map.memory_usage() + 100);
+    bool threw = false;
+    try {
+        map.membership_filter(true);
+    } catch (std::length_error&) {
+        threw = true;
+    }
+    assert(threw && !map.membership_filter() && map.filter_memory_usage() == 0);
+
+    map.memory_budget(map.memory_usage() + 4000);
+    map.membership_filter(true);
+    threw = false;
+    try {
+        for (long i = 1000; ; ++i) {
+            map.emplace(i, i);
+        }
+    } catch (std::length_error&) {
+        threw = true;
+    }
+    assert(threw && map.memory_usage() <= map.memory_budget());
+    for (long i = 0; i < static_cast<long>(map.size()); ++i) {
+        assert(map.find(i) != map.end());
+    }
+}
+
+///-----
+///LruUnorderedMap
+///-----
+
+void testLruEvictionChains() {
+    LruUnorderedMap<long, int> cache(1000);
+    for (long i = 0; i < 1000; ++i) {
+        cache.put(i, 0);
+    }
+
+    // Every put evicts and reuses a node; keys that all land in one bucket must still force a reseed.
+    long stride = static_cast<long>(cache.bucket_count());
+    for (long i = 1; i <= 1000; ++i) {
+        cache.put(i * stride, 0);
+    }
+    assert(cache.size() == 1000);
+    assert(cache.longest_chain() <= 16);
+}
+
+///-----
+///CuckooUnorderedMap
+///-----
+
+void testCuckooAgainstReference() {
+    std::mt19937_64 rng(33);
+    CuckooUnorderedMap<long, long> map;
+    map.max_load_factor(0.95);
+    std::unordered_map<long, long> reference;
+    for (int i = 0; i < 200000; ++i) {
+        long key = rng() % 50000;
+        if (rng() % 3 == 0) {
+            assert(map.erase(key) == reference.erase(key));
+        } else {
+            map[key] = i;
+            reference[key] = i;
+        }
+        assert(map.size() <= map.max_size());
+    }
+
+    assert(map.size() == reference.size());
+    for (auto& node : reference) {
+        assert(map.at(node.first) == node.second);
+    }
+
+    // Range erase of a prefix leaves exactly the entries after it.
+    auto middle = map.begin();
+    for (size_t i = 0; i < map.size() / 2; ++i) {
+        ++middle;
+    }
+    std::vector<long> kept;
+    for (auto it = middle; it != map.end(); ++it) {
+        kept.push_back(it->first);
+    }
+    map.erase(map.begin(), middle);
+    assert(map.size() == kept.size());
+    for (long key : kept) {
+        assert(map.at(key) == reference.at(key));
+    }
+    map.erase(map.begin(), map.end());
+    assert(map.size() == 0 && map.begin() == map.end());
+}
+
+struct ThrowingValue {
+    static long movesLeft;
+    long value;
+
+    ThrowingValue(long value = 0) : value(value) {
+    }
+    ThrowingValue(const ThrowingValue& other) = default;
+    ThrowingValue(ThrowingValue&& other) : value(other.value) {
+        if (movesLeft == 0) {
+            throw std::runtime_error("move failed");
+        }
+        if (movesLeft > 0) {
+            --movesLeft;
+        }
+        other.value = -1;
+    }
+    ThrowingValue& operator=(const ThrowingValue& other) = default;
+    ThrowingValue& operator=(ThrowingValue&& other) {
+        value = other.value;
+        other.value = -1;
+        return *this;
+    }
+};
+long ThrowingValue::movesLeft = -1;
+
+void testCuckooRehashRollback() {
+    CuckooUnorderedMap<long, ThrowingValue> map;
+    for (long i = 0; i < 1000; ++i) {
+        map.emplace(i, ThrowingValue(i));
+    }
+
+    size_t buckets = map.bucket_count();
+    ThrowingValue::movesLeft = 500;
+    bool threw = false;
+    try {
+        map.rehash(buckets * 4);
+    } catch (std::runtime_error&) {
+        threw = true;
+    }
+    ThrowingValue::movesLeft = -1;
+
+    assert(threw);
+    assert(map.size() == 1000 && map.bucket_count() == buckets);
+    for (long i = 0; i < 1000; ++i) {
+        assert(map.at(i).value == i);
+    }
+}
+
+void testCuckooSameHash() {
+    CuckooUnorderedMap<long, int, ConstantHash> map;
+    size_t placed = 0;
+    std::string message;
+    try {
+        for (long i = 0; i < 100; ++i) {
+            map.emplace(i, 0);
+            ++placed;
+        }
+    } catch (std::length_error& error) {
+        message = error.what();
+    }
+
+    assert(message == "too many keys with the same hash value");
+    assert(map.size() == placed && placed > 0);
+    for (long i = 0; i < static_cast<long>(placed); ++i) {
+        assert(map.find(i) != map.end());
+    }
+}
+
+///-----
+///ParallelUM
+///-----
+
+void testParallelReduce() {
+    ThreadPool pool(4);
+    UnorderedMap<long, long> map;
+    for (long i = 1; i < 1000; ++i) {
+        map.emplace(i, i);
+    }
+
+    long sum = parallel_reduce(map, 5L, [](long acc, const std::pair<const long, long>& node) {
+        return acc + node.second;
+    }, std::plus<long>(), 0L, pool);
+    assert(sum == 5 + 999 * 1000 / 2);
+
+    long max = parallel_reduce(map, 0L, [](long acc, const std::pair<const long, long>& node) {
+        return std::max(acc, node.second);
+    }, [](long a, long b) {
+        return std::max(a, b);
+    }, 0L, pool);
+    assert(max == 999);
+}
+
+void testParallelEraseIf() {
+    ThreadPool pool(4);
+    std::mt19937_64 rng(26);
+    UnorderedMap<long, long> map;
+    std::unordered_map<long, long> reference;
+    for (int round = 0; round < 20; ++round) {
+        for (int i = 0; i < 5000; ++i) {
+            long key = rng() % 20000;
+            map.emplace(key, key);
+            reference.emplace(key, key);
+        }
+
+        long divisor = 2 + round % 5;
+        size_t erased = parallel_erase_if(map, [divisor](const std::pair<const long, long>& node) {
+            return node.first % divisor == 0;
+        }, pool);
+        size_t expected = 0;
+        for (auto it = reference.begin(); it != reference.end();) {
+            if (it->first % divisor == 0) {
+                it = reference.erase(it);
+                ++expected;
+            } else {
+                ++it;
+            }
+        }
+
+        assert(erased == expected);
+        assert(map.size() == reference.size());
+        size_t visited = 0;
+        for (auto& node : map) {
+            assert(reference.count(node.first) == 1);
+            ++visited;
+        }
+        assert(visited == reference.size());
+        for (auto& node : reference) {
+            assert(map.at(node.first) == node.second);
+        }
+    }
+}
+
+void testNestedParallelCalls() {
+    ThreadPool pool(4);
+    UnorderedMap<long, long> map;
+    for (long i = 0; i < 100; ++i) {
+        map.emplace(i, 1);
+    }
+
+    std::atomic<long> total(0);
+    parallel_for_each(map, [&](std::pair<const long, long>&) {
+        total += parallel_reduce(map, 0L, [](long acc, const std::pair<const long, long>& node) {
+            return acc + node.second;
+        }, std::plus<long>(), 0L, pool);
+    }, pool);
+    assert(total == 100 * 100);
+}
 
 int main() {
+    testLongestChain();
+    testFilterBudget();
+    testLruEvictionChains();
+    testCuckooAgainstReference();
+    testCuckooRehashRollback();
+    testCuckooSameHash();
+    testParallelReduce();
+    testParallelEraseIf();
+    testNestedParallelCalls();
 
+    std::cout << "OK" << std::endl;
+    return 0;
 }